@@ -0,0 +1,272 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <string.h>
+
+#include "app/activity.h"
+#include "dcs.h"
+#include "driver/bk4819.h"
+#include "driver/eeprom.h"
+#include "driver/systick.h"
+#ifdef ENABLE_UART
+	#include "driver/uart.h"
+	#include "external/printf/printf.h"
+#endif
+#include "misc.h"
+
+#ifdef ENABLE_DTMF_CALLING
+	#error "the activity log lives in the DTMF contacts area"
+#endif
+
+// the first 16 bytes hold the header, the entries follow
+#define ACTIVITY_HEADER        0x1C00
+#define ACTIVITY_START         0x1C10
+#define ACTIVITY_SLOTS         31
+// "ACL" and the layout version, bump it when ACTIVITY_Record_t changes
+#define ACTIVITY_MAGIC         0x014C4341u
+#define ACTIVITY_QUEUE_SIZE    8
+#define ACTIVITY_FLUSH_500ms   120    // a minute
+
+static ACTIVITY_Record_t gQueue[ACTIVITY_QUEUE_SIZE];
+static uint8_t           gQueueCount;
+static uint8_t           gFlushCountdown_500ms;
+
+static uint8_t           gNextSlot;
+static uint16_t          gNextSequence;
+
+static ACTIVITY_Record_t gOpen;
+static bool              gIsOpen;
+
+// 0xFFFF is what an erased slot reads
+static uint16_t ACTIVITY_NextSequence(uint16_t Sequence)
+{
+	return (Sequence >= 0xFFFE) ? 0 : Sequence + 1;
+}
+
+void ACTIVITY_Erase(void)
+{
+	uint8_t      Block[8];
+	unsigned int i;
+
+	memset(Block, 0xFF, sizeof(Block));
+	for (i = ACTIVITY_START; i < ACTIVITY_START + (ACTIVITY_SLOTS * sizeof(ACTIVITY_Record_t)); i += 8)
+		EEPROM_WriteBuffer(i, Block, true);
+
+	EEPROM_WriteBuffer(ACTIVITY_HEADER + 8, Block, true);
+	Block[0] = (ACTIVITY_MAGIC >>  0) & 0xFF;
+	Block[1] = (ACTIVITY_MAGIC >>  8) & 0xFF;
+	Block[2] = (ACTIVITY_MAGIC >> 16) & 0xFF;
+	Block[3] = (ACTIVITY_MAGIC >> 24) & 0xFF;
+	EEPROM_WriteBuffer(ACTIVITY_HEADER, Block, true);
+
+	gIsOpen       = false;
+	gQueueCount   = 0;
+	gNextSlot     = 0;
+	gNextSequence = 0;
+}
+
+void ACTIVITY_Init(void)
+{
+	ACTIVITY_Record_t Records[8];
+	unsigned int      Slot;
+	uint16_t          Previous = 0;
+	uint32_t          Magic;
+
+	gNextSlot     = 0;
+	gNextSequence = 0;
+
+	// contacts, a CHIRP image or an older layout would read as entries
+	EEPROM_ReadBuffer(ACTIVITY_HEADER, &Magic, sizeof(Magic));
+	if (Magic != ACTIVITY_MAGIC)
+	{
+		ACTIVITY_Erase();
+		return;
+	}
+
+	// the newest entry ends the run of consecutive sequence numbers from slot 0
+	for (Slot = 0; Slot < ACTIVITY_SLOTS; Slot++)
+	{
+		uint16_t Sequence;
+
+		if ((Slot % ARRAY_SIZE(Records)) == 0)
+			EEPROM_ReadBuffer(ACTIVITY_START + (Slot * sizeof(ACTIVITY_Record_t)), Records,
+				MIN(ACTIVITY_SLOTS - Slot, ARRAY_SIZE(Records)) * sizeof(ACTIVITY_Record_t));
+
+		Sequence = Records[Slot % ARRAY_SIZE(Records)].Sequence;
+		if (Sequence == 0xFFFF || (Slot > 0 && Sequence != ACTIVITY_NextSequence(Previous)))
+			break;
+
+		Previous      = Sequence;
+		gNextSlot     = (Slot + 1) % ACTIVITY_SLOTS;
+		gNextSequence = ACTIVITY_NextSequence(Sequence);
+	}
+}
+
+void ACTIVITY_Start(uint8_t Source, uint32_t Frequency, uint16_t Rssi)
+{
+	if (gIsOpen)
+	{
+		if (gOpen.Source == Source && gOpen.Frequency == Frequency)
+		{
+			ACTIVITY_Update(Rssi);
+			return;
+		}
+
+		ACTIVITY_End();
+	}
+
+	memset(&gOpen, 0, sizeof(gOpen));
+	gOpen.Frequency = Frequency;
+	gOpen.Time      = gGlobalSysTickCounter;
+	gOpen.Source    = Source;
+	gIsOpen         = true;
+
+	ACTIVITY_Update(Rssi);
+}
+
+void ACTIVITY_Update(uint16_t Rssi)
+{
+	uint32_t       CdcssCode;
+	uint16_t       CtcssFreq;
+	uint8_t        Code;
+	DCS_CodeType_t CodeType;
+
+	if (!gIsOpen)
+		return;
+
+	Rssi /= 2;
+	if (Rssi > gOpen.Rssi)
+		gOpen.Rssi = (Rssi > 0xFF) ? 0xFF : Rssi;
+
+	if (gOpen.CodeType != CODE_TYPE_OFF)
+		return;
+
+	switch (BK4819_GetCxCSSScanResult(&CdcssCode, &CtcssFreq))
+	{
+		case BK4819_CSS_RESULT_CDCSS:
+			Code = DCS_FindCdcssCode(CdcssCode, &CodeType);
+			if (Code != 0xFF)
+			{
+				gOpen.CodeType = CodeType;
+				gOpen.Code     = Code;
+			}
+			break;
+
+		case BK4819_CSS_RESULT_CTCSS:
+			Code = DCS_GetCtcssCode(CtcssFreq);
+			if (Code != 0xFF)
+			{
+				gOpen.CodeType = CODE_TYPE_CONTINUOUS_TONE;
+				gOpen.Code     = Code;
+			}
+			break;
+
+		default:
+			break;
+	}
+}
+
+void ACTIVITY_End(void)
+{
+	const uint32_t Duration = gGlobalSysTickCounter - gOpen.Time;
+
+	if (!gIsOpen)
+		return;
+
+	gIsOpen        = false;
+	gOpen.Duration = (Duration > 0xFFFF) ? 0xFFFF : Duration;
+	gOpen.Sequence = gNextSequence;
+	gNextSequence  = ACTIVITY_NextSequence(gNextSequence);
+
+	if (gQueueCount == 0)
+		gFlushCountdown_500ms = ACTIVITY_FLUSH_500ms;
+
+	gQueue[gQueueCount++] = gOpen;
+	if (gQueueCount == ACTIVITY_QUEUE_SIZE)
+		ACTIVITY_Flush();
+}
+
+void ACTIVITY_TimeSlice500ms(void)
+{
+	if (gQueueCount > 0 && --gFlushCountdown_500ms == 0)
+		ACTIVITY_Flush();
+}
+
+void ACTIVITY_Flush(void)
+{
+	unsigned int i;
+
+	if (gQueueCount == 0)
+		return;
+
+	for (i = 0; i < gQueueCount; i++)
+	{
+		const uint16_t Address = ACTIVITY_START + (gNextSlot * sizeof(ACTIVITY_Record_t));
+
+		EEPROM_WriteBuffer(Address,     (const uint8_t *)&gQueue[i],     true);
+		EEPROM_WriteBuffer(Address + 8, (const uint8_t *)&gQueue[i] + 8, true);
+
+		gNextSlot = (gNextSlot + 1) % ACTIVITY_SLOTS;
+	}
+
+	gQueueCount = 0;
+
+	EEPROM_Flush();
+}
+
+#ifdef ENABLE_UART
+	void ACTIVITY_Dump(void)
+	{
+		ACTIVITY_Record_t Record;
+		char              Line[80];
+		char              Code[8];
+		unsigned int      i;
+
+		ACTIVITY_Flush();
+
+		for (i = 0; i < ACTIVITY_SLOTS; i++)
+		{
+			const unsigned int Slot = (gNextSlot + i) % ACTIVITY_SLOTS;
+
+			EEPROM_ReadBuffer(ACTIVITY_START + (Slot * sizeof(ACTIVITY_Record_t)), &Record, sizeof(Record));
+			if (Record.Sequence == 0xFFFF)
+				continue;
+
+			// the slot may hold anything, so the code is checked before it's looked up
+			if (Record.CodeType == CODE_TYPE_CONTINUOUS_TONE && Record.Code < ARRAY_SIZE(CTCSS_Options))
+				snprintf(Code, sizeof(Code), "%u.%u", CTCSS_Options[Record.Code] / 10, CTCSS_Options[Record.Code] % 10);
+			else
+			if ((Record.CodeType == CODE_TYPE_DIGITAL || Record.CodeType == CODE_TYPE_REVERSE_DIGITAL) && Record.Code < ARRAY_SIZE(DCS_Options))
+				snprintf(Code, sizeof(Code), "D%03o%c", DCS_Options[Record.Code], (Record.CodeType == CODE_TYPE_DIGITAL) ? 'N' : 'I');
+			else
+				strcpy(Code, "-");
+
+			// seq source MHz dBm duration code time
+			snprintf(Line, sizeof(Line), "LOG %u %c %u.%05u %d %u.%02u %s %u.%02u\r\n",
+				Record.Sequence,
+				(Record.Source == ACTIVITY_SOURCE_SPECTRUM) ? 'S' : 'C',
+				(unsigned int)(Record.Frequency / 100000), (unsigned int)(Record.Frequency % 100000),
+				Record.Rssi - 160,
+				Record.Duration / 100, Record.Duration % 100,
+				Code,
+				(unsigned int)(Record.Time / 100), (unsigned int)(Record.Time % 100));
+
+			UART_Send(Line, strlen(Line));
+		}
+
+		UART_Send("LOG END\r\n", 9);
+	}
+#endif
@@ -0,0 +1,68 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef APP_ACTIVITY_H
+#define APP_ACTIVITY_H
+
+#include <stdint.h>
+
+// Log of the signals the scanner and the spectrum stopped on. Entries are
+// collected in RAM and appended a batch at a time to a ring in the EEPROM
+// (the DTMF contacts area, 0x1C00..0x1DFF, a header and 31 entries), old
+// ones are never rewritten until the ring wraps around.
+
+// 16 bytes, two EEPROM write blocks and half a page
+typedef struct
+{
+	uint32_t Frequency;  // 10Hz
+	uint32_t Time;       // 10ms ticks since power on
+	uint16_t Duration;   // 10ms ticks, stops at 0xFFFF
+	uint16_t Sequence;   // running number, the slot after the newest one holds the oldest
+	uint8_t  Rssi;       // peak, dBm + 160
+	uint8_t  CodeType;   // DCS_CodeType_t heard while it lasted
+	uint8_t  Code;
+	uint8_t  Source;     // ACTIVITY_Source_t
+} ACTIVITY_Record_t;
+
+enum ACTIVITY_Source_t
+{
+	ACTIVITY_SOURCE_SCANNER = 0,
+	ACTIVITY_SOURCE_SPECTRUM
+};
+
+// finds the end of the ring, call once the EEPROM is readable. Without
+// the header the area is erased first
+void ACTIVITY_Init(void);
+// empties the log and writes the header, the writes are only queued
+void ACTIVITY_Erase(void);
+
+// a signal was found, ends the previous one if it is somewhere else
+void ACTIVITY_Start(uint8_t Source, uint32_t Frequency, uint16_t Rssi);
+// still there, keeps the peak and looks for a CTCSS/DCS code
+void ACTIVITY_Update(uint16_t Rssi);
+// gone, the entry is queued for the EEPROM
+void ACTIVITY_End(void);
+
+// burns queued entries in every minute, or right away when the queue is full
+void ACTIVITY_TimeSlice500ms(void);
+void ACTIVITY_Flush(void);
+
+#ifdef ENABLE_UART
+	// whole log to the UART, oldest first, one line per entry
+	void ACTIVITY_Dump(void);
+#endif
+
+#endif
@@ -20,6 +20,9 @@
 #include <string.h>
 
 #include "app/action.h"
+#ifdef ENABLE_ACTIVITY_LOG
+	#include "app/activity.h"
+#endif
 #ifdef ENABLE_AIRCOPY
 	#include "app/aircopy.h"
 #endif
@@ -38,11 +41,15 @@
 #include "audio.h"
 #include "board.h"
 #include "bsp/dp32g030/gpio.h"
+#ifdef ENABLE_CHANNEL_CACHE
+	#include "channels.h"
+#endif
 #include "driver/backlight.h"
 #ifdef ENABLE_FMRADIO
 	#include "driver/bk1080.h"
 #endif
 #include "driver/bk4819.h"
+#include "driver/eeprom.h"
 #include "driver/gpio.h"
 #include "driver/keyboard.h"
 #include "driver/st7565.h"
@@ -68,6 +75,9 @@
 #ifdef ENABLE_MESSENGER
 	#include "app/messenger.h"
 #endif
+#ifdef ENABLE_KISS
+	#include "app/kiss.h"
+#endif
 #ifdef ENABLE_ENCRYPTION
 	#include "helper/crypto.h"
 #endif
@@ -84,6 +94,10 @@ static void UpdateRSSI(const int vfo)
 {
 	int16_t rssi = BK4819_GetRSSI();
 
+	#ifdef ENABLE_ACTIVITY_LOG
+		ACTIVITY_Update(rssi);
+	#endif
+
 	if (gCurrentRSSI[vfo] == rssi)
 		return;     // no change
 
@@ -1151,6 +1165,29 @@ void APP_TimeSlice10ms(void)
 	if (gCurrentFunction != FUNCTION_POWER_SAVE || !gRxIdleMode)
 		CheckRadioInterrupts();
 
+	if (gScanStateDir != SCAN_OFF)
+		CHFRSCANNER_CheckDwell();
+
+	#ifdef ENABLE_MESSENGER
+		// queued packets go out in the background, a step every tick
+		FSK_tx_timeslice_10ms();
+	#endif
+
+	#ifdef ENABLE_KISS
+		KISS_TimeSlice10ms();
+	#endif
+
+	#ifdef ENABLE_CHANNEL_CACHE
+		// fill the channel cache a record per tick rather than holding up boot
+		CHANNELS_LoadNext();
+	#endif
+
+	#ifdef ENABLE_ENCRYPTION
+		// nothing to read while the chip sleeps
+		if (gCurrentFunction != FUNCTION_POWER_SAVE || !gRxIdleMode)
+			CRYPTO_TimeSlice10ms();
+	#endif
+
 	if (gCurrentFunction == FUNCTION_TRANSMIT)
 	{	// transmitting
 		#ifdef ENABLE_AUDIO_BAR
@@ -1297,6 +1334,13 @@ void APP_TimeSlice500ms(void)
 {
 	bool exit_menu = false;
 
+	// burn in whatever settings were saved since the last slice
+	EEPROM_Flush();
+
+	#ifdef ENABLE_ACTIVITY_LOG
+		ACTIVITY_TimeSlice500ms();
+	#endif
+
 	#ifdef ENABLE_MESSENGER_NOTIFICATION
 		if (gPlayMSGRing) {
 			gPlayMSGRingCount = 5;
@@ -1316,11 +1360,15 @@ void APP_TimeSlice500ms(void)
 				hasNewMessage = 1;
 			}
 		}	
+		#ifdef ENABLE_APRS
+			MSG_TimeSlice500ms();
+		#endif
 	#endif
 
 	#ifdef ENABLE_ENCRYPTION
 		if(gRecalculateEncKey){
 			CRYPTO_Generate256BitKey(gEeprom.ENC_KEY, gEncryptionKey, sizeof(gEeprom.ENC_KEY));
+			CRYPTO_SetKey(gEncryptionKey, 256);
 			gRecalculateEncKey = false;
 		}
 	#endif
@@ -1405,6 +1453,8 @@ void APP_TimeSlice500ms(void)
 
 		if (gBatteryCalibration[3] < gBatteryCurrentVoltage)
 		{
+			EEPROM_Flush();
+
 			#ifdef ENABLE_OVERLAY
 				overlay_FLASH_RebootToBootloader();
 			#else
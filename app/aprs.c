@@ -9,102 +9,340 @@
 
 #include "app/messenger.h"
 
+#include "driver/systick.h"
 #include "settings.h"
 
 // possibly read from EEPROM in the future
-uint16_t msg_id = 100;
+static uint16_t msg_id = 100;
+
+static APRSOutbound outbox[APRS_OUTBOX_SIZE];
+
+typedef struct {
+    uint32_t key;       // FNV-1a of the frame, 0 for a free entry
+    uint32_t window;    // gGlobalSysTickCounter when its window started
+} APRSDupe;
+
+static APRSDupe dupes[APRS_DUPE_CACHE_SIZE];
 const char * aprs_destination = "APN000"; // apparently dependant on the device
 
-// we only compare the message id for now
-uint8_t APRS_is_ack_for_message(AX25UIFrame* frame, uint16_t for_message_id) {
-    const char *p = frame->info;
-    // Check that the payload starts with ':' and the fixed sequence ":ack" is at the correct offset.
-    if (p[0] != ':' || memcmp(&p[10], ":ack", 4) != 0)
+// ":" addressee ":" in front of the text of a message, ack or reject
+#define APRS_TEXT_OFFSET (1 + ADDRESSEE_SIZE + 1)
+
+// longest message id the spec allows
+#define APRS_MSG_ID_MAX_SIZE 5
+
+uint8_t APRS_parse(AX25View * view, const char * origin, uint16_t len) {
+    if (!AX25_parse(view, origin, len))
         return 0;
-    // TODO: Check the message id
-    
-    return for_message_id == msg_id;
-}
 
-// we only compare the message id for now
-uint8_t APRS_is_ack(AX25UIFrame* frame) {
-    const char *p = frame->info;
-    // Check that the payload starts with ':' and the fixed sequence ":ack" is at the correct offset.
-    if (p[0] != ':' || memcmp(&p[10], ":ack", 4) != 0)
+    // APRS only ever goes out as UI frames without layer 3, poll bit aside
+    const uint8_t control = view->buffer[view->control];
+    if ((control & ~0x10) != AX25_CONTROL_UI ||
+        (uint8_t)view->buffer[view->control + 1] != AX25_PID_NO_LAYER3)
         return 0;
-    
-    return 1;
+
+    return AX25_info_len(view) > 0;
+}
+
+// "ack" or "rej" followed by nothing but the id it refers to
+static APRSType APRS_get_message_type(const char * text, uint16_t len) {
+    if (len < 4 || len > 3 + APRS_MSG_ID_MAX_SIZE)
+        return APRS_TYPE_MESSAGE;
+
+    for (uint16_t i = 3; i < len; i++) {
+        const char c = text[i];
+        if (!(c >= '0' && c <= '9') && !(c >= 'A' && c <= 'Z') && !(c >= 'a' && c <= 'z'))
+            return APRS_TYPE_MESSAGE;
+    }
+
+    if (memcmp(text, "ack", 3) == 0)
+        return APRS_TYPE_ACK;
+    if (memcmp(text, "rej", 3) == 0)
+        return APRS_TYPE_REJECT;
+
+    return APRS_TYPE_MESSAGE;
+}
+
+APRSType APRS_get_type(const AX25View * view) {
+    const char * p = AX25_info(view);
+    const uint16_t len = AX25_info_len(view);
+
+    switch (p[0]) {
+        case ':':
+            if (len < APRS_TEXT_OFFSET || p[APRS_TEXT_OFFSET - 1] != ':')
+                return APRS_TYPE_OTHER;
+            return APRS_get_message_type(p + APRS_TEXT_OFFSET, len - APRS_TEXT_OFFSET);
+        case '!':
+        case '=':
+        case '/':
+        case '@':
+            return APRS_TYPE_POSITION;
+        default:
+            return APRS_TYPE_OTHER;
+    }
 }
 
 // we check if we are the intended recipient of the message
-uint8_t APRS_destined_to_user(AX25UIFrame* frame) {
-    const char *p = frame->info + 1; // skip the ":"
-    return memcmp(&p[0], gEeprom.APRS_CONFIG.callsign, CALLSIGN_SIZE - 1);
-}
-
-uint16_t APRS_get_msg_id(AX25UIFrame* frame) {
-    int16_t offset = AX25_find_offset(frame->info, AX25_IFRAME_MAX_SIZE, APRS_ACK_TOKEN, 0);
-    if(offset != -1) {
-        char p[6];
-        p[5] = 0;
-        strncpy(p, frame->info + offset, 5);
-        return atoi(p);
-    } else {
-        return 0;
+uint8_t APRS_destined_to_user(const AX25View * view) {
+    const char * p = AX25_info(view) + 1; // skip the ":"
+    char addressee[ADDRESSEE_SIZE + 1];
+
+    // the addressee is "CALL-SS" padded with spaces to 9 characters
+    uint8_t n = snprintf(addressee, sizeof(addressee),
+        gEeprom.APRS_CONFIG.ssid ? "%.6s-%u" : "%.6s",
+        gEeprom.APRS_CONFIG.callsign, gEeprom.APRS_CONFIG.ssid);
+    memset(addressee + n, ' ', ADDRESSEE_SIZE - n);
+
+    return AX25_info_len(view) >= APRS_TEXT_OFFSET && memcmp(p, addressee, ADDRESSEE_SIZE) == 0;
+}
+
+// digits of a message id, up to the first character that isn't one
+static uint16_t APRS_parse_id(const char * p, uint16_t len) {
+    uint16_t id = 0;
+    for (uint16_t i = 0; i < len && i < APRS_MSG_ID_MAX_SIZE; i++) {
+        if (p[i] < '0' || p[i] > '9')
+            break;
+        id = id * 10 + (p[i] - '0');
     }
+    return id;
 }
 
-#define ACK_SIZE 1 + ADDRESSEE_SIZE + 1 + 3 + 5 + 1
+uint16_t APRS_get_msg_id(const AX25View * view) {
+    const char * p = AX25_info(view);
+    const uint16_t len = AX25_info_len(view);
 
-char ack_message[ACK_SIZE];
+    int16_t offset = AX25_find_offset(p, len, APRS_ACK_TOKEN, 0);
+    if (offset == -1)
+        return 0;
 
-void APRS_prepare_ack(AX25UIFrame* frame, uint16_t for_message_id, char * for_callsign) {
-    memset(ack_message, 0 , ACK_SIZE * sizeof(char));
-    sprintf(ack_message, ":%s:ack%d", for_callsign, for_message_id);
-    APRS_prepare_message(frame, ack_message, true);
+    return APRS_parse_id(p + offset + 1, len - offset - 1);
 }
 
-// TODO: Bit stuffing per section 3.6 of AX25 spec if needed
-uint16_t APRS_prepare_message(AX25UIFrame* frame, const char * message, uint8_t is_ack) {
+// source, destination and digis, up to the information field
+static void APRS_prepare_header(AX25UIFrame* frame) {
     AX25_clear(frame);
 
-    // source, destination and digis
     AX25_insert_destination(frame, aprs_destination, 0);
     AX25_insert_source(frame, gEeprom.APRS_CONFIG.callsign, gEeprom.APRS_CONFIG.ssid);
     const char * paths[2];
-    paths[0] = gEeprom.APRS_CONFIG.path1;
+    uint8_t path_count = 0;
+    paths[path_count++] = gEeprom.APRS_CONFIG.path1;
     if(*gEeprom.APRS_CONFIG.path2) {
-        paths[1] = gEeprom.APRS_CONFIG.path2;
+        paths[path_count++] = gEeprom.APRS_CONFIG.path2;
     }
-    AX25_insert_paths(frame, paths, 2);
+    AX25_insert_paths(frame, paths, path_count);
+}
 
-    // dump message
-    AX25_insert_info(frame, ":%s{%d", message ,msg_id);
+// FCS and bit stuffing (section 3.6 of AX25 spec) are added by the modem when framing
+void APRS_prepare_ack(AX25UIFrame* frame, uint16_t for_message_id, const char * for_callsign) {
+    APRS_prepare_header(frame);
+    // acks don't get a number of their own
+    AX25_insert_info(frame, ":%-9s:ack%u", for_callsign, for_message_id);
+}
 
-    // increase message count
-    if(!is_ack)
-        msg_id++;
+uint16_t APRS_prepare_outbound(AX25UIFrame* frame, const APRSOutbound * message) {
+    APRS_prepare_header(frame);
+    AX25_insert_info(frame, ":%-9s:%s{%u", message->addressee, message->text, message->id);
 
-    return strlen(frame->raw_buffer);
+    return frame->len;
 }
 
-void APRS_display_received(AX25UIFrame* frame, char * field) {
-    if(!frame->readable) {
-        return;
+APRSOutbound * APRS_outbox_add(const char * message) {
+    // the addressee goes in front, e.g. "N0CALL-9:hello" or "N0CALL   :hello"
+    const uint16_t len = strlen(message);
+    uint16_t start = 0;
+    while (start < len && message[start] == ' ')
+        start++;
+
+    const uint16_t window = start + ADDRESSEE_SIZE + 1;
+    const int16_t colon = AX25_find_offset(message, len < window ? len : window, ':', start);
+    if (colon == -1)
+        return NULL;
+
+    // acks come back from the callsign as it is on air, so it is written
+    // the same way: upper case, no blanks around it and no "-0"
+    uint16_t end = colon;
+    while (end > start && message[end - 1] == ' ')
+        end--;
+    if (end - start >= 2 && message[end - 2] == '-' && message[end - 1] == '0')
+        end -= 2;
+    if (end == start)
+        return NULL;
+
+    // a free entry, otherwise one that is done with
+    APRSOutbound * entry = NULL;
+    for (uint8_t i = 0; i < APRS_OUTBOX_SIZE; i++) {
+        if (outbox[i].state == APRS_DELIVERY_NONE) {
+            entry = &outbox[i];
+            break;
+        }
+        if (entry == NULL && outbox[i].state != APRS_DELIVERY_PENDING)
+            entry = &outbox[i];
     }
-    // dump the message onto the display
-        AX25_get_source(frame, field);
-		sprintf(
-			field + strlen(field), // copy exactly after the destination
-			"> %s",
-			frame->info + 1 // skip the ":"
-		);
+    if (entry == NULL)
+        return NULL;
+
+    for (uint16_t i = start; i < end; i++) {
+        const char c = message[i];
+        entry->addressee[i - start] = (c >= 'a' && c <= 'z') ? c - 'a' + 'A' : c;
+    }
+    entry->addressee[end - start] = 0;
+
+    strncpy(entry->text, message + colon + 1, APRS_MESSAGE_TEXT_SIZE);
+    entry->text[APRS_MESSAGE_TEXT_SIZE] = 0;
+
+    // 0 stands for no id at all
+    entry->id = msg_id++;
+    if (msg_id == 0)
+        msg_id = 1;
+
+    entry->state = APRS_DELIVERY_PENDING;
+    entry->sent = 0;
+    entry->deadline_500ms = 0;
+
+    return entry;
 }
 
-uint8_t APRS_parse(AX25UIFrame* frame, char * origin, uint16_t len) {
-    AX25_clear(frame);
-    // TODO: These lines are just for skipping warnings.
-    frame->readable = *origin;
-    frame->len = len;
-    return false;
+APRSOutbound * APRS_outbox_timeslice_500ms(void) {
+    APRSOutbound * due = NULL;
+
+    for (uint8_t i = 0; i < APRS_OUTBOX_SIZE; i++) {
+        APRSOutbound * entry = &outbox[i];
+        if (entry->state != APRS_DELIVERY_PENDING)
+            continue;
+        if (entry->deadline_500ms > 0)
+            entry->deadline_500ms--;
+        // one at a time, the others stay due until the next slice
+        if (entry->deadline_500ms == 0 && due == NULL)
+            due = entry;
+    }
+
+    if (due != NULL && due->sent >= APRS_MESSAGE_TRANSMISSIONS)
+        due->state = APRS_DELIVERY_TIMEOUT;
+
+    return due;
+}
+
+void APRS_outbox_sent(APRSOutbound * message) {
+    // the usual decaying schedule: 30s, 1, 2, 4 and 8 minutes
+    message->deadline_500ms = APRS_RETRY_FIRST_500MS << message->sent;
+    message->sent++;
+}
+
+APRSOutbound * APRS_outbox_ack(const AX25View * view) {
+    if (!APRS_destined_to_user(view))
+        return NULL;
+
+    const APRSType type = APRS_get_type(view);
+    if (type != APRS_TYPE_ACK && type != APRS_TYPE_REJECT)
+        return NULL;
+
+    // "ack" or "rej", then the id
+    const char * p = AX25_info(view) + APRS_TEXT_OFFSET + 3;
+    const uint16_t id = APRS_parse_id(p, AX25_info_len(view) - APRS_TEXT_OFFSET - 3);
+
+    for (uint8_t i = 0; i < APRS_OUTBOX_SIZE; i++) {
+        APRSOutbound * entry = &outbox[i];
+        // copies coming in over other digipeaters find it settled already
+        if (entry->state != APRS_DELIVERY_PENDING || entry->id != id)
+            continue;
+
+        char source[AX25_ADDRESS_STRING_SIZE + 1];
+        AX25_address_to_string(view, AX25_SOURCE, source);
+        if (strcmp(source, entry->addressee) != 0)
+            continue;
+
+        entry->state = type == APRS_TYPE_ACK ? APRS_DELIVERY_ACKED : APRS_DELIVERY_REJECTED;
+        return entry;
+    }
+
+    return NULL;
+}
+
+#define FNV_OFFSET 2166136261u
+#define FNV_PRIME  16777619u
+
+static uint32_t APRS_hash(uint32_t hash, const char * data, uint16_t len) {
+    for (uint16_t i = 0; i < len; i++)
+        hash = (hash ^ (uint8_t)data[i]) * FNV_PRIME;
+    return hash;
+}
+
+// callsign and SSID, without the H, C and extension bits
+static uint32_t APRS_hash_address(uint32_t hash, const AX25View * view, uint8_t index) {
+    hash = APRS_hash(hash, AX25_address(view, index), CALLSIGN_SIZE - 1);
+    return (hash ^ AX25_ssid(view, index)) * FNV_PRIME;
+}
+
+static uint32_t APRS_dupe_key(const AX25View * view) {
+    uint32_t hash = APRS_hash_address(FNV_OFFSET, view, AX25_SOURCE);
+
+    const uint16_t id = APRS_get_type(view) == APRS_TYPE_MESSAGE ? APRS_get_msg_id(view) : 0;
+    if (id) {
+        hash = APRS_hash(hash, AX25_info(view) + 1, ADDRESSEE_SIZE);
+        hash = APRS_hash(hash, (const char *)&id, sizeof(id));
+    } else {
+        hash = APRS_hash_address(hash, view, AX25_DESTINATION);
+        hash = APRS_hash(hash, AX25_info(view), AX25_info_len(view));
+    }
+
+    // 0 marks a free entry
+    return hash ? hash : 1;
+}
+
+uint32_t APRS_dupe_check(const AX25View * view) {
+    const uint32_t key = APRS_dupe_key(view);
+    const uint32_t now = gGlobalSysTickCounter;
+    APRSDupe * oldest = NULL;
+    uint32_t oldest_age = 0;
+
+    for (uint8_t i = 0; i < APRS_DUPE_CACHE_SIZE; i++) {
+        APRSDupe * entry = &dupes[i];
+        uint32_t age = now - entry->window;
+
+        // free and forgotten entries are the first to go
+        if (entry->key == 0 || age > APRS_DUPE_EXPIRY_10MS)
+            age = APRS_DUPE_EXPIRY_10MS;
+
+        if (entry->key == key && age < APRS_DUPE_EXPIRY_10MS) {
+            if (age >= APRS_DUPE_WINDOW_10MS)
+                entry->window = now;
+            return age;
+        }
+
+        if (oldest == NULL || age > oldest_age) {
+            oldest = entry;
+            oldest_age = age;
+        }
+    }
+
+    oldest->key = key;
+    oldest->window = now;
+
+    return APRS_DUPE_NEVER;
+}
+
+void APRS_display_received(const AX25View * view, char * field) {
+    const char * text = AX25_info(view);
+    uint16_t len = AX25_info_len(view);
+
+    // messages show their text without the addressee and the id
+    if (APRS_get_type(view) == APRS_TYPE_MESSAGE) {
+        text += APRS_TEXT_OFFSET;
+        len -= APRS_TEXT_OFFSET;
+        const int16_t id = AX25_find_offset(text, len, APRS_ACK_TOKEN, 0);
+        if (id != -1)
+            len = id;
+    }
+
+    // dump the message onto the display, the text isn't terminated so it
+    // can't go through printf's %.*s, which peeks one byte past the end
+    AX25_address_to_string(view, AX25_SOURCE, field);
+    uint8_t n = strlen(field);
+    field[n++] = '>';
+    field[n++] = ' ';
+    if (len > MESSAGE_LENGTH + 1 - n)
+        len = MESSAGE_LENGTH + 1 - n;
+    memcpy(field + n, text, len);
+    field[n + len] = 0;
 }
@@ -19,23 +19,137 @@ extern const char * aprs_destination;
 
 #define ADDRESSEE_SIZE 9
 
-extern uint16_t msg_id;
+/** Longest text a message may carry, as per the APRS spec */
+#define APRS_MESSAGE_TEXT_SIZE 67
 
-uint8_t APRS_is_ack_for_message(AX25UIFrame* frame, uint16_t for_message_id);
-uint8_t APRS_is_ack(AX25UIFrame* frame);
-uint8_t APRS_destined_to_user(AX25UIFrame* frame);
-uint16_t APRS_get_msg_id(AX25UIFrame* frame);
-void APRS_prepare_ack(AX25UIFrame* frame, uint16_t for_message_id, char * for_callsign);
+/** Messages waiting for an ack at the same time */
+#define APRS_OUTBOX_SIZE 4
+
+/** Transmissions of a message before giving up on its ack */
+#define APRS_MESSAGE_TRANSMISSIONS 5
+
+/** Wait after the first transmission, doubling after every retry */
+#define APRS_RETRY_FIRST_500MS 60
+
+/** Frames remembered by the duplicate cache */
+#ifdef ENABLE_APRS_DIGI
+  // a busy channel carries about a frame a second, the digipeater sees them all
+  #define APRS_DUPE_CACHE_SIZE 32
+#else
+  #define APRS_DUPE_CACHE_SIZE 16
+#endif
+
+/**
+ * Copies heard within this long of the first one are duplicates. Short
+ * enough that a sender retrying after 30s because our ack got lost gets
+ * acked again, as digipeaters do.
+ */
+#define APRS_DUPE_WINDOW_10MS 2800
+
+/** Frames not heard again for this long are forgotten */
+#define APRS_DUPE_EXPIRY_10MS 60000
+
+/** Returned by APRS_dupe_check for a frame that wasn't heard before */
+#define APRS_DUPE_NEVER 0xFFFFFFFF
+
+typedef enum APRSDelivery {
+    APRS_DELIVERY_NONE,      // slot is free
+    APRS_DELIVERY_PENDING,   // waiting for its ack, sent again when due
+    APRS_DELIVERY_ACKED,
+    APRS_DELIVERY_REJECTED,
+    APRS_DELIVERY_TIMEOUT,   // out of retries
+} APRSDelivery;
+
+typedef struct {
+    char addressee[ADDRESSEE_SIZE + 1];          // "CALL-SS", not padded
+    char text[APRS_MESSAGE_TEXT_SIZE + 1];
+    uint16_t id;
+    uint16_t deadline_500ms;                     // until it is due again
+    uint8_t state;                               // APRSDelivery
+    uint8_t sent;                                // transmissions so far
+} APRSOutbound;
+
+typedef enum APRSType {
+    APRS_TYPE_OTHER,     // anything the messenger has no use for
+    APRS_TYPE_MESSAGE,   // ":ADDRESSEE:text{id"
+    APRS_TYPE_ACK,       // ":ADDRESSEE:ackid"
+    APRS_TYPE_REJECT,    // ":ADDRESSEE:rejid"
+    APRS_TYPE_POSITION,  // '!', '=', '/' or '@'
+} APRSType;
+
+/**
+ * Parses a received frame as APRS: a well formed AX.25 UI frame without
+ * layer 3 and with something in its information field. The view points
+ * into [origin], which has to stay put while it is used.
+ *
+ * @returns 1 for an APRS frame, 0 otherwise
+ */
+uint8_t APRS_parse(AX25View * view, const char * origin, uint16_t len);
+
+/** Tells what kind of packet a parsed frame carries, from its first few bytes */
+APRSType APRS_get_type(const AX25View * view);
+
+uint8_t APRS_destined_to_user(const AX25View * view);
+
+/** The number after '{' in a message, 0 if it has none */
+uint16_t APRS_get_msg_id(const AX25View * view);
+void APRS_prepare_ack(AX25UIFrame* frame, uint16_t for_message_id, const char * for_callsign);
+
+/**
+ * Takes a message typed as "ADDRESSEE:text" into the outbox, due to be sent
+ * straight away. The addressee is stored the way the ack's source reads:
+ * upper case, without blanks around it and without a "-0".
+ *
+ * @returns its outbox entry, NULL if it has no addressee or all entries
+ *          are still waiting for acks
+ */
+APRSOutbound * APRS_outbox_add(const char * message);
+
+/**
+ * Counts down the retry schedule, call every 500ms.
+ *
+ * @returns an entry that needs attention: still PENDING if it has to be sent
+ *          again, TIMEOUT once when it ran out of retries. NULL otherwise.
+ */
+APRSOutbound * APRS_outbox_timeslice_500ms(void);
 
 /**
- * Inserts the message into the provided AX.25 frame.
- * 
- * Please mind that the [readable] flag will become false, as the packet becomes unreadable
- * due to bit stuffing.
+ * Inserts an outbox message into the provided AX.25 frame.
+ *
+ * The frame is left unstuffed and without FCS, HDLC_frame takes care of both
+ * right before it goes into the FIFO.
+ *
+ * @returns the length of the raw frame, in bytes
  */
-uint16_t APRS_prepare_message(AX25UIFrame* frame, const char * message, uint8_t is_ack);
-void APRS_display_received(AX25UIFrame* frame, char * field);
-uint8_t APRS_parse(AX25UIFrame* frame, char * origin, uint16_t len);
+uint16_t APRS_prepare_outbound(AX25UIFrame* frame, const APRSOutbound * message);
+
+/** Schedules the next retry once a message made it into the TX queue */
+void APRS_outbox_sent(APRSOutbound * message);
+
+/**
+ * Matches a received ack or reject against the outbox, by message id and by
+ * the station it was sent to.
+ *
+ * @returns the entry it settled, NULL if there is none waiting for it
+ */
+APRSOutbound * APRS_outbox_ack(const AX25View * view);
+
+/**
+ * Looks a frame up in the duplicate cache, keyed on source and addressee
+ * plus message id for messages, or on source, destination and the whole
+ * information field for anything else, so the path it came over doesn't
+ * matter. Unknown frames are added.
+ *
+ * A frame heard APRS_DUPE_WINDOW_10MS or longer ago starts a new window,
+ * so a later call measures from now.
+ *
+ * @returns 10ms ticks since its window started, APRS_DUPE_NEVER if the
+ *          frame is new
+ */
+uint32_t APRS_dupe_check(const AX25View * view);
+
+/** Writes "SOURCE> text" of a received message into a rxMessage line */
+void APRS_display_received(const AX25View * view, char * field);
 
 
 #endif
\ No newline at end of file
@@ -39,50 +39,107 @@ uint8_t AX25_insert_destination(AX25UIFrame * self, const char * callsign, uint8
     return 1; // Success
 }
 
-uint8_t AX25_get_source(AX25UIFrame * self, char * dst) {
-    if (self == NULL || dst == NULL || self->len < 14) {
-        return 0; // Error - invalid parameters or frame too short
+uint8_t AX25_parse(AX25View * view, const char * buffer, uint16_t len) {
+    uint8_t addresses = 0;
+
+    // every address but the last has bit 0 of its SSID byte clear, the
+    // callsign bytes always do as they are shifted left
+    for (;;) {
+        if (addresses == AX25_MAX_ADDRESSES || (addresses + 1) * CALLSIGN_SIZE > len)
+            return 0;
+
+        const char * address = buffer + addresses * CALLSIGN_SIZE;
+        for (uint8_t i = 0; i < CALLSIGN_SIZE - 1; i++) {
+            if (address[i] & 0x01)
+                return 0;
+        }
+
+        addresses++;
+        if (address[CALLSIGN_SIZE - 1] & 0x01)
+            break;
     }
-    
-    // Source address starts at position 7 (after destination address)
-    char *src_addr = &self->raw_buffer[7];
+
+    // there is always a source after the destination
+    if (addresses < 2)
+        return 0;
+
+    const uint8_t control = addresses * CALLSIGN_SIZE;
+    if (control >= len)
+        return 0;
+
+    // I frames (bit 0 clear) and UI frames, poll/final aside, have a PID
+    const uint8_t control_byte = buffer[control];
+    const uint8_t has_pid = !(control_byte & 0x01) || (control_byte & ~0x10) == AX25_CONTROL_UI;
+
+    if (control + 1 + has_pid > len)
+        return 0;
+
+    view->buffer = buffer;
+    view->len = len;
+    view->addresses = addresses;
+    view->control = control;
+    view->info = control + 1 + has_pid;
+    view->has_pid = has_pid;
+
+    return 1;
+}
+
+uint8_t AX25_address_is(const AX25View * view, uint8_t index, const char * callsign, uint8_t ssid) {
+    const char * address = AX25_address(view, index);
     uint8_t i;
-    uint8_t ssid;
-    
+
+    for (i = 0; i < CALLSIGN_SIZE - 1 && callsign[i]; i++) {
+        if ((uint8_t)address[i] != (uint8_t)(callsign[i] << 1))
+            return 0;
+    }
+    // shorter callsigns are padded with spaces
+    for (; i < CALLSIGN_SIZE - 1; i++) {
+        if ((uint8_t)address[i] != (uint8_t)(' ' << 1))
+            return 0;
+    }
+
+    return AX25_ssid(view, index) == (ssid & 0x0F);
+}
+
+void AX25_set_address(char * buffer, uint8_t index, const char * callsign, uint8_t ssid) {
+    char * address = buffer + index * CALLSIGN_SIZE;
+    uint8_t i;
+
+    for (i = 0; i < CALLSIGN_SIZE - 1 && callsign[i]; i++) {
+        address[i] = callsign[i] << 1;
+    }
+    for (; i < CALLSIGN_SIZE - 1; i++) {
+        address[i] = ' ' << 1;
+    }
+
+    AX25_set_ssid(buffer, index, ssid);
+}
+
+void AX25_address_to_string(const AX25View * view, uint8_t index, char * dst) {
+    const char * address = AX25_address(view, index);
+    const uint8_t ssid = AX25_ssid(view, index);
+    uint8_t i;
+
     // Extract callsign (right-shift by 1 bit)
-    for (i = 0; i < 6; i++) {
-        dst[i] = (src_addr[i] >> 1) & 0x7F;
+    for (i = 0; i < CALLSIGN_SIZE - 1; i++) {
+        dst[i] = (address[i] >> 1) & 0x7F;
     }
-    
+
     // Remove trailing spaces
     while (i > 0 && dst[i-1] == ' ') {
         i--;
     }
-    
-    // Extract SSID from the 7th byte: 111SSID1 format
-    ssid = (src_addr[6] >> 1) & 0x0F;
-    
+
     // Add SSID to string if it's non-zero
     if (ssid > 0) {
-        dst[i] = '-';
-        
-        // Convert SSID to string
-        if (ssid < 10) {
-            // Single digit SSID
-            dst[i+1] = '0' + ssid;
-            dst[i+2] = '\0';
-        } else {
-            // Double digit SSID
-            dst[i+1] = '0' + (ssid / 10);
-            dst[i+2] = '0' + (ssid % 10);
-            dst[i+3] = '\0';
+        dst[i++] = '-';
+        if (ssid >= 10) {
+            dst[i++] = '1';
         }
-    } else {
-        // No SSID, just terminate the string
-        dst[i] = '\0';
+        dst[i++] = '0' + (ssid % 10);
     }
-    
-    return 1; // Success
+
+    dst[i] = '\0';
 }
 
 uint8_t AX25_insert_source(AX25UIFrame * self, const char * callsign, uint8_t ssid) {
@@ -122,8 +179,12 @@ uint8_t AX25_insert_paths(AX25UIFrame * self, const char ** path_strings, uint8_
     
     // If we already have control/PID fields, we need to move them
     if (self->control != NULL && self->pid != NULL) {
-        // Clear the last address's SSID "last bit"
-        self->raw_buffer[self->len - 9] &= 0xFE;
+        self->len -= 2;
+    }
+
+    // Clear the last address's SSID "last bit", the paths go after it
+    if (paths > 0) {
+        self->raw_buffer[self->len - 1] &= 0xFE;
     }
     
     // Add each path
@@ -168,8 +229,9 @@ uint8_t AX25_insert_paths(AX25UIFrame * self, const char ** path_strings, uint8_
         // For the last path, set the last bit to 1
         uint8_t last_bit = (path_idx == paths - 1) ? 0x01 : 0x00;
         
-        // Encode SSID byte: 111SSIDL where L is the last bit
-        self->raw_buffer[self->len++] = 0xE0 | ((ssid & 0x0F) << 1) | last_bit;
+        // Encode SSID byte: 011SSIDL where L is the last bit, H (bit 7)
+        // stays clear until a digipeater has repeated the frame
+        self->raw_buffer[self->len++] = 0x60 | ((ssid & 0x0F) << 1) | last_bit;
     }
     
     // Set up control and PID fields after all addresses
@@ -214,10 +276,10 @@ uint8_t AX25_insert_info(AX25UIFrame * self, const char* format, ...) {
 }
 
 void AX25_clear(AX25UIFrame* frame) {
+    // the buffer is written front to back and len says how far, no need to wipe it
     frame->readable = 0;
     frame->len = 0;
     frame->control = NULL;
     frame->pid = NULL;
     frame->info = NULL;
-    memset(frame->raw_buffer, 0, AX25_IFRAME_MAX_SIZE);
 }
\ No newline at end of file
@@ -17,6 +17,32 @@
 #define AX25_IFRAME_MAX_SIZE CALLSIGN_SIZE + CALLSIGN_SIZE + DIGI_MAX_SIZE + 1 + 1 + INFO_MAX_SIZE // does not consider flag and CRC
 #define AX25_BITSTUFFED_MAX_SIZE ((AX25_IFRAME_MAX_SIZE * 13) / 10)
 
+/** Destination, source and digipeaters */
+#define AX25_MAX_ADDRESSES (2 + MAX_DIGIS)
+
+/** Longest "CALL-SS" an address turns into, without the terminator */
+#define AX25_ADDRESS_STRING_SIZE 9
+
+typedef enum AX25Address {
+    AX25_DESTINATION = 0,
+    AX25_SOURCE      = 1,
+    AX25_FIRST_DIGI  = 2,
+} AX25Address;
+
+/**
+ * A received frame, parsed where it lies. Nothing is copied, every field
+ * is an offset into the buffer the frame was parsed from, so the buffer
+ * has to stay put for as long as the view is used.
+ */
+typedef struct {
+    const char * buffer;
+    uint16_t len;
+    uint8_t addresses;  // destination, source and digipeaters, 2 ~ AX25_MAX_ADDRESSES
+    uint8_t control;    // offset of the control field, right after the addresses
+    uint8_t info;       // offset of the information field, len if there is none
+    uint8_t has_pid;    // UI and I frames carry a PID after control
+} AX25View;
+
 typedef struct {
     char * control;
     char * pid;
@@ -32,7 +58,78 @@ uint8_t AX25_insert_destination(AX25UIFrame * self, const char * callsign, uint8
 
 uint8_t AX25_insert_source(AX25UIFrame * self, const char * callsign, uint8_t ssid);
 
-uint8_t AX25_get_source(AX25UIFrame * self, char * dst);
+/**
+ * Checks the address chain through its extension bits and notes where
+ * every field starts, in a single pass and without copying anything.
+ *
+ * @returns 1 for a well formed frame, 0 otherwise
+ */
+uint8_t AX25_parse(AX25View * view, const char * buffer, uint16_t len);
+
+/** The 7 on-air bytes of an address, callsign still shifted left */
+static inline const char * AX25_address(const AX25View * view, uint8_t index) {
+    return view->buffer + index * CALLSIGN_SIZE;
+}
+
+static inline uint8_t AX25_ssid(const AX25View * view, uint8_t index) {
+    return (AX25_address(view, index)[CALLSIGN_SIZE - 1] >> 1) & 0x0F;
+}
+
+/** H bit of a digipeater, set once it has repeated the frame */
+static inline uint8_t AX25_repeated(const AX25View * view, uint8_t index) {
+    return (AX25_address(view, index)[CALLSIGN_SIZE - 1] & 0x80) ? 1 : 0;
+}
+
+static inline uint8_t AX25_digis(const AX25View * view) {
+    return view->addresses - AX25_FIRST_DIGI;
+}
+
+static inline const char * AX25_info(const AX25View * view) {
+    return view->buffer + view->info;
+}
+
+static inline uint16_t AX25_info_len(const AX25View * view) {
+    return view->len - view->info;
+}
+
+/** First digipeater that hasn't repeated the frame yet, 0 if there is none */
+static inline uint8_t AX25_next_digi(const AX25View * view) {
+    for (uint8_t i = AX25_FIRST_DIGI; i < view->addresses; i++) {
+        if (!AX25_repeated(view, i))
+            return i;
+    }
+    return 0;
+}
+
+/*
+ * The setters below change an address in place, in the buffer [view] was
+ * parsed from, so a received frame can be sent on without building it
+ * again. The extension bit is left alone.
+ */
+
+static inline void AX25_set_ssid(char * buffer, uint8_t index, uint8_t ssid) {
+    char * address = buffer + index * CALLSIGN_SIZE;
+    address[CALLSIGN_SIZE - 1] = (address[CALLSIGN_SIZE - 1] & ~0x1E) | ((ssid & 0x0F) << 1);
+}
+
+static inline void AX25_set_repeated(char * buffer, uint8_t index) {
+    buffer[index * CALLSIGN_SIZE + CALLSIGN_SIZE - 1] |= 0x80;
+}
+
+/** Puts another callsign and SSID in place of an address, e.g. our own for WIDE1-1 */
+void AX25_set_address(char * buffer, uint8_t index, const char * callsign, uint8_t ssid);
+
+/**
+ * Compares an address with a plain callsign and SSID, straight on the
+ * shifted bytes.
+ */
+uint8_t AX25_address_is(const AX25View * view, uint8_t index, const char * callsign, uint8_t ssid);
+
+/**
+ * Writes an address as "CALL-SS", or "CALL" for SSID 0, terminated.
+ * [dst] takes AX25_ADDRESS_STRING_SIZE + 1 bytes.
+ */
+void AX25_address_to_string(const AX25View * view, uint8_t index, char * dst);
 
 uint8_t AX25_insert_paths(AX25UIFrame * self, const char ** path_strings, uint8_t paths);
 
@@ -1,6 +1,11 @@
 
+#ifdef ENABLE_ACTIVITY_LOG
+	#include "app/activity.h"
+#endif
 #include "app/app.h"
 #include "app/chFrScanner.h"
+#include "driver/bk4819.h"
+#include "frequencies.h"
 #include "functions.h"
 #include "misc.h"
 #include "settings.h"
@@ -27,6 +32,12 @@ uint32_t            initialFrqOrChan;
 uint8_t           	initialCROSS_BAND_RX_TX;
 uint32_t            lastFoundFrqOrChan;
 
+// the dwell on a step is cut short once the RSSI settled below the squelch
+#define SCAN_DWELL_MIN_10ms   3   // PLL lock and the RSSI filter need about this long
+#define SCAN_DWELL_SETTLED    4   // 2dB between two ticks
+static uint8_t      dwellTicks;
+static uint16_t     dwellRssi;
+
 static void NextFreqChannel(void);
 static void NextMemChannel(void);
 
@@ -83,7 +94,11 @@ void CHFRSCANNER_ContinueScanning(void)
 		else
 			NextMemChannel();    // switch to next channel
 	}
-	
+
+	#ifdef ENABLE_ACTIVITY_LOG
+		ACTIVITY_End();
+	#endif
+
 	gScanPauseMode      = false;
 	gRxReceptionMode    = RX_MODE_NONE;
 	gScheduleScanListen = false;
@@ -116,6 +131,9 @@ void CHFRSCANNER_Found(void)
 		lastFoundFrqOrChan = gRxVfo->freq_config_RX.Frequency;
 	}
 
+	#ifdef ENABLE_ACTIVITY_LOG
+		ACTIVITY_Start(ACTIVITY_SOURCE_SCANNER, gRxVfo->freq_config_RX.Frequency, BK4819_GetRSSI());
+	#endif
 
 	gScanKeepResult = true;
 }
@@ -129,6 +147,10 @@ void CHFRSCANNER_Stop(void)
 	
 	gScanStateDir = SCAN_OFF;
 
+	#ifdef ENABLE_ACTIVITY_LOG
+		ACTIVITY_End();
+	#endif
+
 	const uint32_t chFr = gScanKeepResult ? lastFoundFrqOrChan : initialFrqOrChan;
 	const bool channelChanged = chFr != initialFrqOrChan;
 	if (IS_MR_CHANNEL(gNextMrChannel)) {
@@ -156,6 +178,8 @@ void CHFRSCANNER_Stop(void)
 
 static void NextFreqChannel(void)
 {
+	const FREQUENCY_Band_t band = FREQUENCY_GetBand(gRxVfo->freq_config_RX.Frequency);
+
 #ifdef ENABLE_SCAN_RANGES
 	if(gScanRangeStart) {
 		gRxVfo->freq_config_RX.Frequency = APP_SetFreqByStepAndLimits(gRxVfo, gScanStateDir, gScanRangeStart, gScanRangeStop);
@@ -165,8 +189,18 @@ static void NextFreqChannel(void)
 		gRxVfo->freq_config_RX.Frequency = APP_SetFrequencyByStep(gRxVfo, gScanStateDir);
 
 	RADIO_ApplyTxOffset(gRxVfo);
-	RADIO_ConfigureSquelchAndOutputPower(gRxVfo);
-	RADIO_SetupRegisters(true);
+
+	if (gCurrentFunction == FUNCTION_FOREGROUND)
+	{	// only the frequency moved
+		RADIO_Retune(FREQUENCY_GetBand(gRxVfo->freq_config_RX.Frequency) != band);
+	}
+	else
+	{
+		RADIO_ConfigureSquelchAndOutputPower(gRxVfo);
+		RADIO_SetupRegisters(true);
+	}
+
+	dwellTicks = 0;
 
 #ifdef ENABLE_FASTER_CHANNEL_SCAN
 	gScanPauseDelayIn_10ms = 9;   // 90ms
@@ -261,6 +295,8 @@ static void NextMemChannel(void)
 		gUpdateDisplay = true;
 	}
 
+	dwellTicks = 0;
+
 #ifdef ENABLE_FASTER_CHANNEL_SCAN
 	gScanPauseDelayIn_10ms = 9;  // 90ms .. <= ~60ms it misses signals (squelch response and/or PLL lock time) ?
 #else
@@ -271,3 +307,24 @@ static void NextMemChannel(void)
 		if (++currentScanList >= SCAN_NEXT_NUM)
 			currentScanList = SCAN_NEXT_CHAN_SCANLIST1;  // back round we go
 }
+
+void CHFRSCANNER_CheckDwell(void)
+{
+	uint16_t rssi;
+
+	if (gScanStateDir == SCAN_OFF || gScanPauseMode || gScheduleScanListen || gCurrentFunction != FUNCTION_FOREGROUND)
+		return;
+
+	rssi = BK4819_GetRSSI();
+
+	// with the squelch off the thresholds are 0 and we never move on early
+	if (++dwellTicks >= SCAN_DWELL_MIN_10ms &&
+	    rssi < gRxVfo->SquelchCloseRSSIThresh &&
+	    rssi + SCAN_DWELL_SETTLED >= dwellRssi && rssi <= dwellRssi + SCAN_DWELL_SETTLED)
+	{	// nothing here that the squelch could open on
+		gScanPauseDelayIn_10ms = 0;
+		gScheduleScanListen    = true;
+	}
+
+	dwellRssi = rssi;
+}
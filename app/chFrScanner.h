@@ -19,5 +19,7 @@ void CHFRSCANNER_Found(void);
 void CHFRSCANNER_Stop(void);
 void CHFRSCANNER_Start(const bool storeBackupSettings, const int8_t scan_direction);
 void CHFRSCANNER_ContinueScanning(void);
+// every 10ms while scanning, ends the pause on a step early when there is clearly nothing there
+void CHFRSCANNER_CheckDwell(void);
 
 #endif
\ No newline at end of file
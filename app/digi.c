@@ -0,0 +1,104 @@
+#include <stdint.h>
+
+#include "app/digi.h"
+
+#include "app/aprs.h"
+#include "app/ax25.h"
+#include "app/fsk.h"
+#ifdef ENABLE_UART
+    #include "driver/uart.h"
+    #include "external/printf/printf.h"
+#endif
+#include "settings.h"
+
+DIGIStats digi_stats;
+
+// n of a WIDEn address, 0 for anything else
+static uint8_t DIGI_wide_n(const AX25View * view, uint8_t index) {
+    static const char wide[] = "WIDE";
+    const char * address = AX25_address(view, index);
+
+    for (uint8_t i = 0; i < sizeof(wide) - 1; i++) {
+        if ((uint8_t)address[i] != (uint8_t)(wide[i] << 1))
+            return 0;
+    }
+    if ((uint8_t)address[5] != (uint8_t)(' ' << 1))
+        return 0;
+
+    const uint8_t n = ((uint8_t)address[4] >> 1) - '0';
+    return n >= 1 && n <= DIGI_MAX_HOPS ? n : 0;
+}
+
+uint8_t DIGI_repeat(char * buffer, const AX25View * view, uint32_t heard) {
+    const uint8_t max_hops = gEeprom.MESSENGER_CONFIG.data.digi;
+    const char * callsign = gEeprom.APRS_CONFIG.callsign;
+    const uint8_t ssid = gEeprom.APRS_CONFIG.ssid;
+
+    // without a callsign there is nothing to put in the path or to tell
+    // our own frames by
+    if (max_hops == 0 || callsign[0] == 0 || callsign[0] == ' ')
+        return 0;
+
+    // sent direct, or every digipeater on the path had its turn
+    const uint8_t digi = AX25_next_digi(view);
+    if (digi == 0)
+        return 0;
+
+    // our own frames come back from other digipeaters
+    if (AX25_address_is(view, AX25_SOURCE, callsign, ssid))
+        return 0;
+
+    uint8_t remaining = 0;
+    if (!AX25_address_is(view, digi, callsign, ssid)) {
+        const uint8_t n = DIGI_wide_n(view, digi);
+        remaining = AX25_ssid(view, digi);
+        // not a WIDEn-N, or one that makes no sense
+        if (n == 0 || remaining == 0 || remaining > n)
+            return 0;
+        if (n > max_hops) {
+            digi_stats.too_many_hops++;
+            return 0;
+        }
+    }
+
+    // the path doesn't count, so this also catches other digipeaters
+    // repeating the same frame, and our own repeat coming back
+    if (heard < APRS_DUPE_WINDOW_10MS) {
+        digi_stats.duplicates++;
+        return 0;
+    }
+
+    if (remaining > 1) {
+        AX25_set_ssid(buffer, digi, remaining - 1);
+    } else {
+        // routed through us by name, or the last hop of a WIDEn-N
+        if (remaining == 1)
+            AX25_set_address(buffer, digi, callsign, ssid);
+        AX25_set_repeated(buffer, digi);
+    }
+
+    if (!FSK_queue_repeat(buffer, view->len)) {
+        digi_stats.queue_full++;
+        return 0;
+    }
+
+    digi_stats.forwarded++;
+    return 1;
+}
+
+#ifdef ENABLE_UART
+void DIGI_report(void) {
+    char line[64];
+    const int len = snprintf(
+        line,
+        sizeof(line),
+        "DIGI fwd %u dup %u hops %u full %u lat %ums\r\n",
+        digi_stats.forwarded,
+        digi_stats.duplicates,
+        digi_stats.too_many_hops,
+        digi_stats.queue_full,
+        (unsigned int)FSK_repeat_latency_ms()
+    );
+    UART_Send(line, len);
+}
+#endif
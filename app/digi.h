@@ -0,0 +1,53 @@
+/**
+ * @file digi.h
+ *
+ * WIDEn-N digipeater. Frames are repeated straight out of the buffer they
+ * were received into: the path is updated in place and the frame goes
+ * back into the FSK TX queue as it is, without building it again.
+ */
+
+#ifndef DIGI_H
+#define DIGI_H
+
+#include <stdint.h>
+
+#include "app/ax25.h"
+
+#ifndef ENABLE_APRS
+  #error "ENABLE_APRS_DIGI repeats AX.25 frames, it needs ENABLE_APRS"
+#endif
+
+/** Highest the Digi setting goes, WIDE7-7 */
+#define DIGI_MAX_HOPS 7
+
+typedef struct {
+    uint16_t forwarded;
+    uint16_t duplicates;     // heard again within the dupe window
+    uint16_t too_many_hops;  // WIDEn-N with n above the Digi setting
+    uint16_t queue_full;     // no room left in the TX queue
+} DIGIStats;
+
+extern DIGIStats digi_stats;
+
+/**
+ * Repeats a received frame if the next hop of its path is our callsign or
+ * a WIDEn-N within the Digi setting. Nothing is repeated while no callsign
+ * is set. Our callsign gets its H bit set. A
+ * WIDEn-N has N counted down, and when it runs out our callsign takes
+ * its place, marked as repeated.
+ *
+ * @param buffer Buffer [view] was parsed from, the path is changed in it
+ * @param heard  What APRS_dupe_check said about the frame
+ * @returns 1 if the frame was queued for TX
+ */
+uint8_t DIGI_repeat(char * buffer, const AX25View * view, uint32_t heard);
+
+#ifdef ENABLE_UART
+/**
+ * Writes the counters to the UART, with the latency of the last repeat
+ * from the end of its RX to its first bits going out
+ */
+void DIGI_report(void);
+#endif
+
+#endif
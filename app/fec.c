@@ -0,0 +1,256 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "app/fec.h"
+
+// GF(256) over x^8 + x^4 + x^3 + x^2 + 1, powers of alpha written out twice
+// so the sum of two logs never needs reducing
+static const uint8_t gf_exp[510] = {
+    0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1D, 0x3A, 0x74, 0xE8, 0xCD, 0x87, 0x13, 0x26,
+    0x4C, 0x98, 0x2D, 0x5A, 0xB4, 0x75, 0xEA, 0xC9, 0x8F, 0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0xC0,
+    0x9D, 0x27, 0x4E, 0x9C, 0x25, 0x4A, 0x94, 0x35, 0x6A, 0xD4, 0xB5, 0x77, 0xEE, 0xC1, 0x9F, 0x23,
+    0x46, 0x8C, 0x05, 0x0A, 0x14, 0x28, 0x50, 0xA0, 0x5D, 0xBA, 0x69, 0xD2, 0xB9, 0x6F, 0xDE, 0xA1,
+    0x5F, 0xBE, 0x61, 0xC2, 0x99, 0x2F, 0x5E, 0xBC, 0x65, 0xCA, 0x89, 0x0F, 0x1E, 0x3C, 0x78, 0xF0,
+    0xFD, 0xE7, 0xD3, 0xBB, 0x6B, 0xD6, 0xB1, 0x7F, 0xFE, 0xE1, 0xDF, 0xA3, 0x5B, 0xB6, 0x71, 0xE2,
+    0xD9, 0xAF, 0x43, 0x86, 0x11, 0x22, 0x44, 0x88, 0x0D, 0x1A, 0x34, 0x68, 0xD0, 0xBD, 0x67, 0xCE,
+    0x81, 0x1F, 0x3E, 0x7C, 0xF8, 0xED, 0xC7, 0x93, 0x3B, 0x76, 0xEC, 0xC5, 0x97, 0x33, 0x66, 0xCC,
+    0x85, 0x17, 0x2E, 0x5C, 0xB8, 0x6D, 0xDA, 0xA9, 0x4F, 0x9E, 0x21, 0x42, 0x84, 0x15, 0x2A, 0x54,
+    0xA8, 0x4D, 0x9A, 0x29, 0x52, 0xA4, 0x55, 0xAA, 0x49, 0x92, 0x39, 0x72, 0xE4, 0xD5, 0xB7, 0x73,
+    0xE6, 0xD1, 0xBF, 0x63, 0xC6, 0x91, 0x3F, 0x7E, 0xFC, 0xE5, 0xD7, 0xB3, 0x7B, 0xF6, 0xF1, 0xFF,
+    0xE3, 0xDB, 0xAB, 0x4B, 0x96, 0x31, 0x62, 0xC4, 0x95, 0x37, 0x6E, 0xDC, 0xA5, 0x57, 0xAE, 0x41,
+    0x82, 0x19, 0x32, 0x64, 0xC8, 0x8D, 0x07, 0x0E, 0x1C, 0x38, 0x70, 0xE0, 0xDD, 0xA7, 0x53, 0xA6,
+    0x51, 0xA2, 0x59, 0xB2, 0x79, 0xF2, 0xF9, 0xEF, 0xC3, 0x9B, 0x2B, 0x56, 0xAC, 0x45, 0x8A, 0x09,
+    0x12, 0x24, 0x48, 0x90, 0x3D, 0x7A, 0xF4, 0xF5, 0xF7, 0xF3, 0xFB, 0xEB, 0xCB, 0x8B, 0x0B, 0x16,
+    0x2C, 0x58, 0xB0, 0x7D, 0xFA, 0xE9, 0xCF, 0x83, 0x1B, 0x36, 0x6C, 0xD8, 0xAD, 0x47, 0x8E, 0x01,
+    0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1D, 0x3A, 0x74, 0xE8, 0xCD, 0x87, 0x13, 0x26, 0x4C,
+    0x98, 0x2D, 0x5A, 0xB4, 0x75, 0xEA, 0xC9, 0x8F, 0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0xC0, 0x9D,
+    0x27, 0x4E, 0x9C, 0x25, 0x4A, 0x94, 0x35, 0x6A, 0xD4, 0xB5, 0x77, 0xEE, 0xC1, 0x9F, 0x23, 0x46,
+    0x8C, 0x05, 0x0A, 0x14, 0x28, 0x50, 0xA0, 0x5D, 0xBA, 0x69, 0xD2, 0xB9, 0x6F, 0xDE, 0xA1, 0x5F,
+    0xBE, 0x61, 0xC2, 0x99, 0x2F, 0x5E, 0xBC, 0x65, 0xCA, 0x89, 0x0F, 0x1E, 0x3C, 0x78, 0xF0, 0xFD,
+    0xE7, 0xD3, 0xBB, 0x6B, 0xD6, 0xB1, 0x7F, 0xFE, 0xE1, 0xDF, 0xA3, 0x5B, 0xB6, 0x71, 0xE2, 0xD9,
+    0xAF, 0x43, 0x86, 0x11, 0x22, 0x44, 0x88, 0x0D, 0x1A, 0x34, 0x68, 0xD0, 0xBD, 0x67, 0xCE, 0x81,
+    0x1F, 0x3E, 0x7C, 0xF8, 0xED, 0xC7, 0x93, 0x3B, 0x76, 0xEC, 0xC5, 0x97, 0x33, 0x66, 0xCC, 0x85,
+    0x17, 0x2E, 0x5C, 0xB8, 0x6D, 0xDA, 0xA9, 0x4F, 0x9E, 0x21, 0x42, 0x84, 0x15, 0x2A, 0x54, 0xA8,
+    0x4D, 0x9A, 0x29, 0x52, 0xA4, 0x55, 0xAA, 0x49, 0x92, 0x39, 0x72, 0xE4, 0xD5, 0xB7, 0x73, 0xE6,
+    0xD1, 0xBF, 0x63, 0xC6, 0x91, 0x3F, 0x7E, 0xFC, 0xE5, 0xD7, 0xB3, 0x7B, 0xF6, 0xF1, 0xFF, 0xE3,
+    0xDB, 0xAB, 0x4B, 0x96, 0x31, 0x62, 0xC4, 0x95, 0x37, 0x6E, 0xDC, 0xA5, 0x57, 0xAE, 0x41, 0x82,
+    0x19, 0x32, 0x64, 0xC8, 0x8D, 0x07, 0x0E, 0x1C, 0x38, 0x70, 0xE0, 0xDD, 0xA7, 0x53, 0xA6, 0x51,
+    0xA2, 0x59, 0xB2, 0x79, 0xF2, 0xF9, 0xEF, 0xC3, 0x9B, 0x2B, 0x56, 0xAC, 0x45, 0x8A, 0x09, 0x12,
+    0x24, 0x48, 0x90, 0x3D, 0x7A, 0xF4, 0xF5, 0xF7, 0xF3, 0xFB, 0xEB, 0xCB, 0x8B, 0x0B, 0x16, 0x2C,
+    0x58, 0xB0, 0x7D, 0xFA, 0xE9, 0xCF, 0x83, 0x1B, 0x36, 0x6C, 0xD8, 0xAD, 0x47, 0x8E,
+};
+
+// gf_log[0] is never used
+static const uint8_t gf_log[256] = {
+    0x00, 0x00, 0x01, 0x19, 0x02, 0x32, 0x1A, 0xC6, 0x03, 0xDF, 0x33, 0xEE, 0x1B, 0x68, 0xC7, 0x4B,
+    0x04, 0x64, 0xE0, 0x0E, 0x34, 0x8D, 0xEF, 0x81, 0x1C, 0xC1, 0x69, 0xF8, 0xC8, 0x08, 0x4C, 0x71,
+    0x05, 0x8A, 0x65, 0x2F, 0xE1, 0x24, 0x0F, 0x21, 0x35, 0x93, 0x8E, 0xDA, 0xF0, 0x12, 0x82, 0x45,
+    0x1D, 0xB5, 0xC2, 0x7D, 0x6A, 0x27, 0xF9, 0xB9, 0xC9, 0x9A, 0x09, 0x78, 0x4D, 0xE4, 0x72, 0xA6,
+    0x06, 0xBF, 0x8B, 0x62, 0x66, 0xDD, 0x30, 0xFD, 0xE2, 0x98, 0x25, 0xB3, 0x10, 0x91, 0x22, 0x88,
+    0x36, 0xD0, 0x94, 0xCE, 0x8F, 0x96, 0xDB, 0xBD, 0xF1, 0xD2, 0x13, 0x5C, 0x83, 0x38, 0x46, 0x40,
+    0x1E, 0x42, 0xB6, 0xA3, 0xC3, 0x48, 0x7E, 0x6E, 0x6B, 0x3A, 0x28, 0x54, 0xFA, 0x85, 0xBA, 0x3D,
+    0xCA, 0x5E, 0x9B, 0x9F, 0x0A, 0x15, 0x79, 0x2B, 0x4E, 0xD4, 0xE5, 0xAC, 0x73, 0xF3, 0xA7, 0x57,
+    0x07, 0x70, 0xC0, 0xF7, 0x8C, 0x80, 0x63, 0x0D, 0x67, 0x4A, 0xDE, 0xED, 0x31, 0xC5, 0xFE, 0x18,
+    0xE3, 0xA5, 0x99, 0x77, 0x26, 0xB8, 0xB4, 0x7C, 0x11, 0x44, 0x92, 0xD9, 0x23, 0x20, 0x89, 0x2E,
+    0x37, 0x3F, 0xD1, 0x5B, 0x95, 0xBC, 0xCF, 0xCD, 0x90, 0x87, 0x97, 0xB2, 0xDC, 0xFC, 0xBE, 0x61,
+    0xF2, 0x56, 0xD3, 0xAB, 0x14, 0x2A, 0x5D, 0x9E, 0x84, 0x3C, 0x39, 0x53, 0x47, 0x6D, 0x41, 0xA2,
+    0x1F, 0x2D, 0x43, 0xD8, 0xB7, 0x7B, 0xA4, 0x76, 0xC4, 0x17, 0x49, 0xEC, 0x7F, 0x0C, 0x6F, 0xF6,
+    0x6C, 0xA1, 0x3B, 0x52, 0x29, 0x9D, 0x55, 0xAA, 0xFB, 0x60, 0x86, 0xB1, 0xBB, 0xCC, 0x3E, 0x5A,
+    0xCB, 0x59, 0x5F, 0xB0, 0x9C, 0xA9, 0xA0, 0x51, 0x0B, 0xF5, 0x16, 0xEB, 0x7A, 0x75, 0x2C, 0xD7,
+    0x4F, 0xAE, 0xD5, 0xE9, 0xE6, 0xE7, 0xAD, 0xE8, 0x74, 0xD6, 0xF4, 0xEA, 0xA8, 0x50, 0x58, 0xAF,
+};
+
+// logs of the generator polynomial (x - a^0)(x - a^1)..(x - a^15) below its
+// leading x^16, highest power first, none of them is zero
+static const uint8_t generator_log[FEC_PARITY] = {
+    0x78, 0x68, 0x6B, 0x6D, 0x66, 0xA1, 0x4C, 0x03, 0x5B, 0xBF, 0x93, 0xA9, 0xB6, 0xC2, 0xE1, 0x78,
+};
+
+static inline uint8_t FEC_mul(uint8_t a, uint8_t b) {
+    if (a == 0 || b == 0)
+        return 0;
+    return gf_exp[gf_log[a] + gf_log[b]];
+}
+
+static inline uint8_t FEC_div(uint8_t a, uint8_t b) {
+    if (a == 0)
+        return 0;
+    return gf_exp[gf_log[a] + 255 - gf_log[b]];
+}
+
+uint16_t FEC_encode(const char * src, uint16_t len, char * dest) {
+    uint8_t parity[FEC_PARITY];
+
+    if (len == 0 || len > FEC_MAX_DATA)
+        return 0;
+
+    dest[0] = dest[1] = dest[2] = len;
+    memcpy(dest + FEC_HEADER, src, len);
+
+    // remainder of data * x^16 divided by the generator
+    memset(parity, 0, sizeof(parity));
+    for (uint16_t i = 0; i < len; i++) {
+        const uint8_t feedback = (uint8_t)src[i] ^ parity[0];
+
+        memmove(parity, parity + 1, FEC_PARITY - 1);
+        parity[FEC_PARITY - 1] = 0;
+
+        if (feedback) {
+            const uint8_t log_feedback = gf_log[feedback];
+            for (uint8_t j = 0; j < FEC_PARITY; j++)
+                parity[j] ^= gf_exp[log_feedback + generator_log[j]];
+        }
+    }
+
+    memcpy(dest + FEC_HEADER + len, parity, FEC_PARITY);
+
+    return FEC_ENCODED_SIZE(len);
+}
+
+/**
+ * Fixes up to FEC_PARITY / 2 bytes of a codeword of [n] bytes in place,
+ * data first, with Berlekamp-Massey, a Chien search and Forney.
+ *
+ * @returns 0 on success, -1 if there were too many errors
+ */
+static int8_t FEC_correct(uint8_t * codeword, uint8_t n) {
+    uint8_t syndrome[FEC_PARITY];
+    uint8_t locator[FEC_PARITY + 1];   // error locator, lowest power first
+    uint8_t previous[FEC_PARITY + 1];
+    uint8_t evaluator[FEC_PARITY / 2]; // error evaluator, lowest power first
+
+    // S_j = r(a^j), all of them in one pass over the bytes
+    memset(syndrome, 0, sizeof(syndrome));
+    for (uint8_t i = 0; i < n; i++) {
+        for (uint8_t j = 0; j < FEC_PARITY; j++) {
+            const uint8_t s = syndrome[j];
+            syndrome[j] = (s ? gf_exp[gf_log[s] + j] : 0) ^ codeword[i];
+        }
+    }
+
+    uint8_t clean = 1;
+    for (uint8_t j = 0; j < FEC_PARITY; j++)
+        clean &= syndrome[j] == 0;
+    if (clean)
+        return 0;
+
+    // Berlekamp-Massey
+    memset(locator, 0, sizeof(locator));
+    memset(previous, 0, sizeof(previous));
+    locator[0] = previous[0] = 1;
+
+    uint8_t degree = 0;
+    uint8_t shift = 1;
+    uint8_t last_discrepancy = 1;
+
+    for (uint8_t k = 0; k < FEC_PARITY; k++) {
+        uint8_t discrepancy = syndrome[k];
+        for (uint8_t i = 1; i <= degree; i++)
+            discrepancy ^= FEC_mul(locator[i], syndrome[k - i]);
+
+        if (discrepancy == 0) {
+            shift++;
+            continue;
+        }
+
+        const uint8_t scale = FEC_div(discrepancy, last_discrepancy);
+
+        if (2 * degree <= k) {
+            uint8_t saved[FEC_PARITY + 1];
+            memcpy(saved, locator, sizeof(saved));
+            for (uint8_t i = 0; i + shift <= FEC_PARITY; i++)
+                locator[i + shift] ^= FEC_mul(scale, previous[i]);
+            degree = k + 1 - degree;
+            memcpy(previous, saved, sizeof(previous));
+            last_discrepancy = discrepancy;
+            shift = 1;
+        } else {
+            for (uint8_t i = 0; i + shift <= FEC_PARITY; i++)
+                locator[i + shift] ^= FEC_mul(scale, previous[i]);
+            shift++;
+        }
+    }
+
+    if (degree > FEC_PARITY / 2)
+        return -1;
+
+    // only the terms below the number of errors are needed for Forney
+    for (uint8_t k = 0; k < degree; k++) {
+        evaluator[k] = 0;
+        for (uint8_t i = 0; i <= k; i++)
+            evaluator[k] ^= FEC_mul(locator[i], syndrome[k - i]);
+    }
+
+    // Chien search, term[i] walks through locator[i] * a^(-p * i) for the
+    // byte p places from the end
+    uint8_t term[FEC_PARITY / 2 + 1];
+    uint8_t found = 0;
+
+    memcpy(term, locator, degree + 1);
+
+    for (uint8_t p = 0; p < n; p++) {
+        uint8_t sum = 0;
+        for (uint8_t i = 0; i <= degree; i++)
+            sum ^= term[i];
+
+        if (sum == 0) {
+            // X^-1 = a^-p, the error is X * evaluator(X^-1) / locator'(X^-1)
+            const uint8_t x_inv_log = p ? 255 - p : 0;
+            uint8_t numerator = 0;
+            uint8_t denominator = 0;
+            uint8_t power_log = 0;  // log of X^-k
+            uint8_t below_log = 0;  // log of X^-(k-1)
+
+            for (uint8_t k = 0; k <= degree; k++) {
+                if (k < degree && evaluator[k])
+                    numerator ^= gf_exp[gf_log[evaluator[k]] + power_log];
+                // formal derivative, odd terms move down a power
+                if ((k & 1) && locator[k])
+                    denominator ^= gf_exp[gf_log[locator[k]] + below_log];
+
+                const uint16_t next_log = (uint16_t)power_log + x_inv_log;
+                below_log = power_log;
+                power_log = next_log >= 255 ? next_log - 255 : next_log;
+            }
+
+            if (denominator == 0)
+                return -1;
+
+            if (numerator) {
+                uint16_t magnitude_log = gf_log[numerator] + 255 - gf_log[denominator];
+                if (magnitude_log >= 255)
+                    magnitude_log -= 255;
+                codeword[n - 1 - p] ^= gf_exp[magnitude_log + p];
+            }
+            found++;
+        }
+
+        for (uint8_t i = 1; i <= degree; i++) {
+            if (term[i])
+                term[i] = gf_exp[gf_log[term[i]] + 255 - i];
+        }
+    }
+
+    // a locator with roots outside the codeword means too many errors
+    return found == degree ? 0 : -1;
+}
+
+int16_t FEC_decode(char * buffer, uint16_t len) {
+    if (len < FEC_HEADER)
+        return -1;
+
+    // bitwise majority of the three copies
+    const uint8_t a = buffer[0];
+    const uint8_t b = buffer[1];
+    const uint8_t c = buffer[2];
+    const uint8_t data_len = (a & b) | (a & c) | (b & c);
+
+    if (data_len == 0 || data_len > FEC_MAX_DATA || FEC_ENCODED_SIZE(data_len) > len)
+        return -1;
+
+    if (FEC_correct((uint8_t *)buffer + FEC_HEADER, data_len + FEC_PARITY) < 0)
+        return -1;
+
+    memmove(buffer, buffer + FEC_HEADER, data_len);
+    return data_len;
+}
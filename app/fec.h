@@ -0,0 +1,49 @@
+/**
+ * @file fec.h
+ *
+ * Forward error correction for the plain messenger frames.
+ *
+ * A frame goes on air as
+ *
+ *   <len> <len> <len> <data, len bytes> <parity, FEC_PARITY bytes>
+ *
+ * where data and parity form a shortened Reed-Solomon codeword over
+ * GF(256), so up to FEC_PARITY / 2 damaged bytes anywhere in it are put
+ * right. A burst of bit errors only takes out the bytes it touches, so
+ * this copes with bursts of up to 57 bits without any interleaving. The
+ * length is sent three times and taken by a bitwise majority, the decoder
+ * needs it before it can find the parity.
+ */
+
+#ifndef FEC_H
+#define FEC_H
+
+#include <stdint.h>
+
+#define FEC_HEADER 3u
+#define FEC_PARITY 16u
+
+/** Longest frame a single codeword takes */
+#define FEC_MAX_DATA (255u - FEC_PARITY)
+
+/** Bytes on air for a frame of [len] bytes */
+#define FEC_ENCODED_SIZE(len) (FEC_HEADER + (len) + FEC_PARITY)
+
+/**
+ * Writes the header, [src] and its parity to [dest], which has to hold
+ * FEC_ENCODED_SIZE(len) bytes.
+ *
+ * @returns number of bytes written, 0 if [len] is over FEC_MAX_DATA
+ */
+uint16_t FEC_encode(const char * src, uint16_t len, char * dest);
+
+/**
+ * Corrects a received frame in place and moves its data to the start of
+ * [buffer]. Anything after the parity, e.g. FIFO padding, is ignored.
+ *
+ * @param len Number of bytes received
+ * @returns length of the data, -1 if the frame can't be put right
+ */
+int16_t FEC_decode(char * buffer, uint16_t len);
+
+#endif
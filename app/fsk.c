@@ -28,12 +28,17 @@
 #include "driver/bk4819.h"
 #include "settings.h"
 #include "driver/system.h"
+#include "driver/systick.h"
 #include "app.h"
 #include "functions.h"
 #include "app/fsk.h"
 #include "ui/ui.h"
 #include "audio.h"
 #include "misc.h"
+#include "app/hdlc/hdlc.h"
+#ifdef ENABLE_MESSENGER_FEC
+    #include "app/fec.h"
+#endif
 
 #define TX_FIFO_SEGMENT 64u
 #define TX_FIFO_THRESHOLD 64u
@@ -58,13 +63,66 @@ uint16_t processed_sync_01;
 uint16_t processed_sync_23;
 uint8_t nrzi_sync_state;
 
+#ifdef ENABLE_APRS
+    // AX.25 frames are deframed straight out of the FIFO, as words arrive
+    HDLCDeframer deframer;
+#endif
+
+typedef enum FSKTxState {
+    FSK_TX_IDLE,
+    FSK_TX_HOLDOFF,  // frame queued, waiting before keying up
+    FSK_TX_KEYUP,    // PTT on, waiting for the transmitter to settle
+    FSK_TX_ARMED,    // FSK TX on, waiting for the modem to take the FIFO
+    FSK_TX_STREAM,   // refilling the FIFO every time it runs low
+    FSK_TX_TAIL,     // FIFO drained, waiting for the last bits to go out
+    FSK_TX_RELEASE,  // modulator restored, waiting to drop PTT
+} FSKTxState;
+
+typedef struct {
+    char data[FSK_TX_FRAME_SIZE];
+    uint16_t len;
+    uint8_t holdoff_10ms;
+    #ifdef ENABLE_APRS_DIGI
+        uint8_t repeat;     // queued by FSK_queue_repeat
+        uint32_t heard_ms;  // SYSTICK_GetMs at the end of RX, for a repeat
+    #endif
+} FSKTxFrame;
+
+static FSKTxFrame tx_queue[FSK_TX_QUEUE_SIZE];
+static uint8_t tx_queue_head;
+static uint8_t tx_queue_count;
+
+static FSKTxState tx_state = FSK_TX_IDLE;
+static uint8_t tx_countdown_10ms;
+static uint16_t tx_index;
+static uint16_t transmit_len;
+
+// registers borrowed from the voice path while sending
+static uint16_t css_val;
+static uint16_t dev_val;
+static uint16_t filt_val;
+
+#ifdef ENABLE_APRS_DIGI
+    static uint32_t rx_end_ms;
+    static uint32_t repeat_latency_ms;
+
+    // notes when the closing flag came in before handing the frame on, so
+    // a repeat can count its latency from the end of RX
+    static void FSK_deliver_frame(char * data, uint16_t len) {
+        rx_end_ms = SYSTICK_GetMs();
+        FSK_receive_callback(data, len);
+    }
+#endif
+
 uint16_t FSK_set_data_length(uint16_t len);
+static void FSK_handle_tx_interrupt(const uint16_t interrupt_bits);
 
 /**
  * Decodes an NRZI (Non-Return-to-Zero Inverted) encoded buffer back to its original form
  * where '0' caused a state change and '1' maintained the state during encoding
  * 
- * This implementation processes the buffer in-place, one byte at a time
+ * This implementation processes the buffer in-place, one byte at a time,
+ * without branching on every bit
  * 
  * @param buffer The buffer to decode in-place
  * @param length Length of the buffer in bytes
@@ -76,33 +134,11 @@ int8_t FSK_decode_nrzi(char *buffer, size_t length, uint8_t initial_state) {
         return -1;
     }
 
-    uint8_t prev_bit = initial_state;
-    
-    char encoded_byte;
+    uint8_t level = initial_state;
 
-    // Process each byte in the buffer
+    // Process each byte in the buffer, all 8 bits at once
     for (size_t i = 0; i < length; i++) {
-        // Save the encoded byte value
-        encoded_byte = buffer[i];
-        // Clear the current byte for writing the decoded value
-        buffer[i] = 0;
-        
-        // Process each bit in the byte (MSB first)
-        for (int8_t bit_idx = 7; bit_idx >= 0; bit_idx--) {
-            // Extract the current bit from the encoded byte
-            uint8_t current_bit = (encoded_byte >> bit_idx) & 0x01;
-            
-            // If the state changed, it was a '0' bit, otherwise it was a '1' bit
-            uint8_t decoded_bit = (current_bit == prev_bit) ? 1 : 0;
-            
-            // Set the decoded bit in the output
-            if (decoded_bit) {
-                buffer[i] |= (1 << bit_idx);
-            }
-            
-            // Update the previous bit for the next iteration
-            prev_bit = current_bit;
-        }
+        buffer[i] = HDLC_nrzi_decode(buffer[i], &level);
     }
     
     return 0;
@@ -112,7 +148,8 @@ int8_t FSK_decode_nrzi(char *buffer, size_t length, uint8_t initial_state) {
  * Encodes a buffer of bytes into NRZI (Non-Return-to-Zero Inverted) format
  * where '0' causes a state change and '1' maintains the current state
  * 
- * This implementation processes the buffer in-place, one byte at a time
+ * This implementation processes the buffer in-place, one byte at a time,
+ * without branching on every bit
  * 
  * @param buffer The buffer to encode in-place
  * @param length Length of the buffer in bytes
@@ -123,34 +160,11 @@ int8_t FSK_encode_nrzi(char *buffer, size_t length, uint8_t initial_nrzi_state)
         return -1;
     }
 
-    uint8_t nrzi_state = initial_nrzi_state;
+    uint8_t level = initial_nrzi_state;
 
-    char original_byte;
-
-    // Process each byte in the buffer
+    // Process each byte in the buffer, all 8 bits at once
     for (size_t i = 0; i < length; i++) {
-        // Save the original byte value
-        original_byte = buffer[i];
-        // Clear the current byte for writing the encoded value
-        buffer[i] = 0;
-
-        // Process each bit in the byte (MSB first)
-        for (int8_t bit_idx = 7; bit_idx >= 0; bit_idx--) {
-            // Extract the current bit from the original byte
-            uint8_t bit = (original_byte >> bit_idx) & 0x01;
-
-            // In this NRZI variant, a '0' bit causes a state change
-            if (bit == 0) {
-                nrzi_state = !nrzi_state;
-            }
-            // '1' bit maintains the current state (no change needed)
-
-            // Set or clear the bit in the output at the same position
-            if (nrzi_state) {
-                buffer[i] |= (1 << bit_idx);
-            }
-            // If nrzi_state is 0, the bit remains 0 (already cleared)
-        }
+        buffer[i] = HDLC_nrzi_encode(buffer[i], &level);
     }
     return 0;
 }
@@ -228,6 +242,13 @@ void FSK_init(
     _sync_23 = sync_23;
     _sync_01 = sync_01;
     FSK_configure();
+    #ifdef ENABLE_APRS
+        #ifdef ENABLE_APRS_DIGI
+            HDLC_deframer_init(&deframer, FSK_deliver_frame, gEeprom.FSK_CONFIG.data.nrzi);
+        #else
+            HDLC_deframer_init(&deframer, receive_callback, gEeprom.FSK_CONFIG.data.nrzi);
+        #endif
+    #endif
     FSK_disable_tx();
     if(gEeprom.FSK_CONFIG.data.receive) {
         BK4819_FskEnableRx();
@@ -245,6 +266,8 @@ void FSK_store_packet_interrupt(const uint16_t interrupt_bits) {
 
 	//UART_printf("\nMSG : S%i, F%i, E%i | %i", rx_sync, rx_fifo_almost_full, rx_finished, interrupt_bits);
 
+	FSK_handle_tx_interrupt(interrupt_bits);
+
 	if (rx_sync) {
         switch(modem_status) {
             case READY:
@@ -256,6 +279,10 @@ void FSK_store_packet_interrupt(const uint16_t interrupt_bits) {
                         AUDIO_AudioPathOff();
                 #endif
                 gFSKWriteIndex = 0;
+                #ifdef ENABLE_APRS
+                    deframer.nrzi = gEeprom.FSK_CONFIG.data.nrzi;
+                    HDLC_deframer_reset(&deframer, nrzi_sync_state);
+                #endif
                 break;
             case SYNCING:
                 break;
@@ -279,10 +306,15 @@ void FSK_store_packet_interrupt(const uint16_t interrupt_bits) {
                 const uint16_t count = BK4819_ReadRegister(BK4819_REG_5E) & (7u << 0);  // almost full threshold
                 for (uint16_t i = 0; i < count; i++) {
                     const uint16_t word = BK4819_ReadRegister(BK4819_REG_5F);
-                    if (gFSKWriteIndex < sizeof(transit_buffer))
-                        transit_buffer[gFSKWriteIndex++] = (word >> 0) & 0xff;
-                    if (gFSKWriteIndex < sizeof(transit_buffer))
-                        transit_buffer[gFSKWriteIndex++] = (word >> 8) & 0xff;
+                    #ifdef ENABLE_APRS
+                        // frames are handed to the callback on their closing flag
+                        HDLC_deframer_push(&deframer, word);
+                    #else
+                        if (gFSKWriteIndex < sizeof(transit_buffer))
+                            transit_buffer[gFSKWriteIndex++] = (word >> 0) & 0xff;
+                        if (gFSKWriteIndex < sizeof(transit_buffer))
+                            transit_buffer[gFSKWriteIndex++] = (word >> 8) & 0xff;
+                    #endif
                 }
                 break;
             case SENDING:
@@ -308,6 +340,24 @@ void FSK_store_packet_interrupt(const uint16_t interrupt_bits) {
 	}
 }
 
+#ifndef ENABLE_APRS
+/**
+ * Hands a received frame to the callback, after putting it right if it
+ * was sent with FEC
+ */
+static void FSK_deliver(char * data, uint16_t len) {
+    #ifdef ENABLE_MESSENGER_FEC
+        if(gEeprom.FSK_CONFIG.data.fec) {
+            const int16_t decoded = FEC_decode(data, len);
+            if(decoded < 0)
+                return; // too damaged to put right, as good as not heard
+            len = decoded;
+        }
+    #endif
+    FSK_receive_callback(data, len);
+}
+#endif
+
 void FSK_end_rx() {
     // turn off the LEDs
     BK4819_ToggleGpioOut(BK4819_GPIO6_PIN2_GREEN, 0);
@@ -317,6 +367,10 @@ void FSK_end_rx() {
         BK4819_FskEnableRx();
     modem_status = READY;
 
+    #ifdef ENABLE_APRS
+        // everything complete was already delivered, drop the partial frame
+        HDLC_deframer_reset(&deframer, nrzi_sync_state);
+    #else
     if (gFSKWriteIndex > 2) {
         if(FSK_receive_callback){
             if(gEeprom.FSK_CONFIG.data.nrzi) {
@@ -324,19 +378,20 @@ void FSK_end_rx() {
                 char * beginning = FSK_find_end_of_sync_words(transit_buffer, gFSKWriteIndex);
                 if(beginning) { // please don't send a null pointer to the callback.
                     uint16_t new_len = gFSKWriteIndex - (beginning - transit_buffer);
-                    FSK_receive_callback(beginning, new_len); // Potentially refiring an Ack.
+                    FSK_deliver(beginning, new_len); // Potentially refiring an Ack.
                 }
             } else {
-                FSK_receive_callback(transit_buffer, gFSKWriteIndex); // Potentially refiring an Ack.
+                FSK_deliver(transit_buffer, gFSKWriteIndex); // Potentially refiring an Ack.
             }
         }
     }
+    #endif
     gFSKWriteIndex = 0;
     memset(transit_buffer, 0, TRANSIT_BUFFER_SIZE);
 }
 
 uint16_t FSK_set_data_length(uint16_t len) {
-    uint8_t rounded_length = (((len + 1) / 2) * 2) + 2;
+    uint16_t rounded_length = (((len + 1) / 2) * 2) + 2;
     
     // Read the current value of register 5D
     uint16_t current_value = BK4819_ReadRegister(BK4819_REG_5D);
@@ -378,215 +433,104 @@ uint16_t FSK_get_data_length() {
 }
 
 
-void FSK_configure() {
-    uint16_t TONE1_FREQ;
-    uint16_t TONE2_FREQ;
-    // REG_70
-    //
-    // <15>   0 Enable TONE1
-    //        1 = Enable
-    //        0 = Disable
-    //
-    // <14:8> 0 TONE1 tuning gain
-    //        0 ~ 127
-    //
-    // <7>    0 Enable TONE2
-    //        1 = Enable
-    //        0 = Disable
-    //
-    // <6:0>  0 TONE2/FSK tuning gain
-    //        0 ~ 127
-    //
-    switch(gEeprom.FSK_CONFIG.data.modulation)
-    {
-        case MOD_AFSK_1200:
-        case MOD_BELL_202:
-            TONE1_FREQ = 22714u;
-            TONE2_FREQ = 12389u;
-            break;
-        case MOD_FSK_700:
-            TONE2_FREQ = 7227u;
-            break;
-        case MOD_FSK_450:
-            TONE2_FREQ = 4646u;
-            break;
-    }
-
-    switch(gEeprom.FSK_CONFIG.data.modulation)
-    {
-        case MOD_BELL_202:
-            BK4819_WriteRegister(BK4819_REG_70,
-                ( 1u << 15) |    // 1
-                ( 0u <<  8) |    // 0
-                ( 1u <<  7) |    // 1
-                (96u <<  0));    // 96
-
-            // TONE 1
-            BK4819_WriteRegister(BK4819_REG_71, TONE1_FREQ);
-            // TONE 2
-            BK4819_WriteRegister(BK4819_REG_72, TONE2_FREQ);
-            break;
-        default:
-            BK4819_WriteRegister(BK4819_REG_70,
-                ( 0u << 15) |    // 0
-                ( 0u <<  8) |    // 0
-                ( 1u <<  7) |    // 1
-                (96u <<  0));    // 96
-
-            // TONE 2 only
-            BK4819_WriteRegister(BK4819_REG_72, TONE2_FREQ);
-            break;
-    }
+// REG_70
+//
+// <15>   0 Enable TONE1
+//        1 = Enable
+//        0 = Disable
+//
+// <14:8> 0 TONE1 tuning gain
+//        0 ~ 127
+//
+// <7>    0 Enable TONE2
+//        1 = Enable
+//        0 = Disable
+//
+// <6:0>  0 TONE2/FSK tuning gain
+//        0 ~ 127
+//
+#define FSK_REG_70(tone1) (((tone1) << 15) | (0u << 8) | (1u << 7) | (96u << 0))
+
+// REG_58
+//
+// <15:13> FSK TX mode selection
+//         0 = FSK 1.2K and FSK 2.4K TX .. no tones, direct FM
+//         1 = FFSK 1200 / 1800 TX
+//         3 = FFSK 1200 / 2400 TX
+//         5 = NOAA SAME TX
+//
+// <12:10> FSK RX mode selection
+//         0 = FSK 1.2K, FSK 2.4K RX and NOAA SAME RX .. no tones, direct FM
+//         4 = FFSK 1200 / 2400 RX
+//         7 = FFSK 1200 / 1800 RX
+//
+// <9:8>   3 FSK RX gain, 0 ~ 3
+//
+// <7:6>   0 ???
+//
+// <5:4>   0 FSK preamble type selection
+//         0 = 0xAA or 0x55 due to the MSB of FSK sync byte 0
+//         2 = 0x55
+//         3 = 0xAA
+//
+// <3:1>   FSK RX bandwidth setting
+//         0 = FSK 1.2K .. no tones, direct FM
+//         1 = FFSK 1200 / 1800
+//         2 = NOAA SAME RX
+//         4 = FSK 2.4K and FFSK 1200 / 2400
+//
+// <0>     1 FSK enable
+//
+#define FSK_REG_58(tx_mode, rx_mode, rx_bw) \
+    (((tx_mode) << 13) | ((rx_mode) << 10) | (3u << 8) | (0u << 6) | (0u << 4) | ((rx_bw) << 1) | (1u << 0))
+
+static const BK4819_RegisterWrite_t FSK_modulation_fsk_450[] = {
+    BK4819_REG_WRITE(BK4819_REG_70, FSK_REG_70(0u)),
+    BK4819_REG_WRITE(BK4819_REG_72, 4646u),     // TONE 2 only
+    BK4819_REG_WRITE(BK4819_REG_58, FSK_REG_58(0u, 0u, 0u)),
+};
+
+static const BK4819_RegisterWrite_t FSK_modulation_fsk_700[] = {
+    BK4819_REG_WRITE(BK4819_REG_70, FSK_REG_70(0u)),
+    BK4819_REG_WRITE(BK4819_REG_72, 7227u),     // TONE 2 only
+    BK4819_REG_WRITE(BK4819_REG_58, FSK_REG_58(0u, 0u, 0u)),
+};
+
+static const BK4819_RegisterWrite_t FSK_modulation_afsk_1200[] = {
+    BK4819_REG_WRITE(BK4819_REG_70, FSK_REG_70(0u)),
+    BK4819_REG_WRITE(BK4819_REG_72, 12389u),    // TONE 2 only
+    BK4819_REG_WRITE(BK4819_REG_58, FSK_REG_58(1u, 7u, 1u)),
+};
+
+static const BK4819_RegisterWrite_t FSK_modulation_bell_202[] = {
+    BK4819_REG_WRITE(BK4819_REG_70, FSK_REG_70(1u)),
+    BK4819_REG_WRITE(BK4819_REG_71, 22714u),    // TONE 1
+    BK4819_REG_WRITE(BK4819_REG_72, 12389u),    // TONE 2
+    BK4819_REG_WRITE(BK4819_REG_58, FSK_REG_58(1u, 7u, 1u)),
+};
+
+// modulation dependent registers, indexed by ModemModulation
+static const struct {
+    const BK4819_RegisterWrite_t * regs;
+    uint8_t count;
+} FSK_modulation_regs[] = {
+    [MOD_FSK_450]   = {FSK_modulation_fsk_450,   ARRAY_SIZE(FSK_modulation_fsk_450)},
+    [MOD_FSK_700]   = {FSK_modulation_fsk_700,   ARRAY_SIZE(FSK_modulation_fsk_700)},
+    [MOD_AFSK_1200] = {FSK_modulation_afsk_1200, ARRAY_SIZE(FSK_modulation_afsk_1200)},
+    [MOD_BELL_202]  = {FSK_modulation_bell_202,  ARRAY_SIZE(FSK_modulation_bell_202)},
+};
+
+static const BK4819_RegisterWrite_t FSK_common_regs[] = {
+    // disable CRC
+    BK4819_REG_WRITE(BK4819_REG_5C, 0x5625),
+    // set the almost empty tx and almost full rx threshold
+    BK4819_REG_WRITE(BK4819_REG_5E, (TX_FIFO_THRESHOLD << 3) | (RX_FIFO_THRESHOLD << 0)),  // 0 ~ 127, 0 ~ 7
+};
 
-    
-    switch(gEeprom.FSK_CONFIG.data.modulation)
-    {
-        case MOD_FSK_700:
-        case MOD_FSK_450:
-            BK4819_WriteRegister(BK4819_REG_58,
-                (0u << 13) |		// 1 FSK TX mode selection
-                                    //   0 = FSK 1.2K and FSK 2.4K TX .. no tones, direct FM
-                                    //   1 = FFSK 1200 / 1800 TX
-                                    //   2 = ???
-                                    //   3 = FFSK 1200 / 2400 TX
-                                    //   4 = ???
-                                    //   5 = NOAA SAME TX
-                                    //   6 = ???
-                                    //   7 = ???
-                                    //
-                (0u << 10) |		// 0 FSK RX mode selection
-                                    //   0 = FSK 1.2K, FSK 2.4K RX and NOAA SAME RX .. no tones, direct FM
-                                    //   1 = ???
-                                    //   2 = ???
-                                    //   3 = ???
-                                    //   4 = FFSK 1200 / 2400 RX
-                                    //   5 = ???
-                                    //   6 = ???
-                                    //   7 = FFSK 1200 / 1800 RX
-                                    //
-                (3u << 8) |			// 0 FSK RX gain
-                                    //   0 ~ 3
-                                    //
-                (0u << 6) |			// 0 ???
-                                    //   0 ~ 3
-                                    //
-                (0u << 4) |			// 0 FSK preamble type selection
-                                    //   0 = 0xAA or 0x55 due to the MSB of FSK sync byte 0
-                                    //   1 = ???
-                                    //   2 = 0x55
-                                    //   3 = 0xAA
-                                    //
-                (0u << 1) |			// 1 FSK RX bandwidth setting
-                                    //   0 = FSK 1.2K .. no tones, direct FM
-                                    //   1 = FFSK 1200 / 1800
-                                    //   2 = NOAA SAME RX
-                                    //   3 = ???
-                                    //   4 = FSK 2.4K and FFSK 1200 / 2400
-                                    //   5 = ???
-                                    //   6 = ???
-                                    //   7 = ???
-                                    //
-                (1u << 0));			// 1 FSK enable
-                                    //   0 = disable
-                                    //   1 = enable
-        break;
-        case MOD_BELL_202:
-            BK4819_WriteRegister(BK4819_REG_58,
-                (1u << 13) |		// 1 FSK TX mode selection
-                                    //   0 = FSK 1.2K and FSK 2.4K TX .. no tones, direct FM
-                                    //   1 = FFSK 1200 / 1800 TX
-                                    //   2 = ???
-                                    //   3 = FFSK 1200 / 2400 TX
-                                    //   4 = ???
-                                    //   5 = NOAA SAME TX
-                                    //   6 = ???
-                                    //   7 = ???
-                                    //
-                (7u << 10) |		// 0 FSK RX mode selection
-                                    //   0 = FSK 1.2K, FSK 2.4K RX and NOAA SAME RX .. no tones, direct FM
-                                    //   1 = ???
-                                    //   2 = ???
-                                    //   3 = ???
-                                    //   4 = FFSK 1200 / 2400 RX
-                                    //   5 = ???
-                                    //   6 = ???
-                                    //   7 = FFSK 1200 / 1800 RX
-                                    //
-                (3u << 8) |			// 0 FSK RX gain
-                                    //   0 ~ 3
-                                    //
-                (0u << 6) |			// 0 ???
-                                    //   0 ~ 3
-                                    //
-                (0u << 4) |			// 0 FSK preamble type selection
-                                    //   0 = 0xAA or 0x55 due to the MSB of FSK sync byte 0
-                                    //   1 = ???
-                                    //   2 = 0x55
-                                    //   3 = 0xAA
-                                    //
-                (1u << 1) |			// 1 FSK RX bandwidth setting
-                                    //   0 = FSK 1.2K .. no tones, direct FM
-                                    //   1 = FFSK 1200 / 1800
-                                    //   2 = NOAA SAME RX
-                                    //   3 = ???
-                                    //   4 = FSK 2.4K and FFSK 1200 / 2400
-                                    //   5 = ???
-                                    //   6 = ???
-                                    //   7 = ???
-                                    //
-                (1u << 0));			// 1 FSK enable
-                                    //   0 = disable
-                                    //   1 = enable
-            break;
-        case MOD_AFSK_1200:
-            BK4819_WriteRegister(BK4819_REG_58,
-                (1u << 13) |		// 1 FSK TX mode selection
-                                    //   0 = FSK 1.2K and FSK 2.4K TX .. no tones, direct FM
-                                    //   1 = FFSK 1200 / 1800 TX
-                                    //   2 = ???
-                                    //   3 = FFSK 1200 / 2400 TX
-                                    //   4 = ???
-                                    //   5 = NOAA SAME TX
-                                    //   6 = ???
-                                    //   7 = ???
-                                    //
-                (7u << 10) |		// 0 FSK RX mode selection
-                                    //   0 = FSK 1.2K, FSK 2.4K RX and NOAA SAME RX .. no tones, direct FM
-                                    //   1 = ???
-                                    //   2 = ???
-                                    //   3 = ???
-                                    //   4 = FFSK 1200 / 2400 RX
-                                    //   5 = ???
-                                    //   6 = ???
-                                    //   7 = FFSK 1200 / 1800 RX
-                                    //
-                (3u << 8) |			// 0 FSK RX gain
-                                    //   0 ~ 3
-                                    //
-                (0u << 6) |			// 0 ???
-                                    //   0 ~ 3
-                                    //
-                (0u << 4) |			// 0 FSK preamble type selection
-                                    //   0 = 0xAA or 0x55 due to the MSB of FSK sync byte 0
-                                    //   1 = ???
-                                    //   2 = 0x55
-                                    //   3 = 0xAA
-                                    //
-                (1u << 1) |			// 1 FSK RX bandwidth setting
-                                    //   0 = FSK 1.2K .. no tones, direct FM
-                                    //   1 = FFSK 1200 / 1800
-                                    //   2 = NOAA SAME RX
-                                    //   3 = ???
-                                    //   4 = FSK 2.4K and FFSK 1200 / 2400
-                                    //   5 = ???
-                                    //   6 = ???
-                                    //   7 = ???
-                                    //
-                (1u << 0));			// 1 FSK enable
-                                    //   0 = disable
-                                    //   1 = enable
-            break;
-    }
+void FSK_configure() {
+    const uint32_t bus_writes = gBK4819_BusWrites;
+    const uint8_t modulation = gEeprom.FSK_CONFIG.data.modulation;
+    BK4819_WriteRegisters(FSK_modulation_regs[modulation].regs, FSK_modulation_regs[modulation].count);
 
     if(gEeprom.FSK_CONFIG.data.nrzi) {
         processed_sync_01 = _sync_01;
@@ -625,11 +569,7 @@ void FSK_configure() {
     // < 7:0> sync byte 3
     BK4819_WriteRegister(BK4819_REG_5B, processed_sync_23);
 
-    // disable CRC
-    BK4819_WriteRegister(BK4819_REG_5C, 0x5625);
-
-    // set the almost empty tx and almost full rx threshold
-    BK4819_WriteRegister(BK4819_REG_5E, (TX_FIFO_THRESHOLD << 3) | (RX_FIFO_THRESHOLD << 0));  // 0 ~ 127, 0 ~ 7
+    BK4819_WriteRegisters(FSK_common_regs, ARRAY_SIZE(FSK_common_regs));
 
     // packet size .. sync + packet - size of a single packet
 
@@ -663,15 +603,79 @@ void FSK_configure() {
 
     // clear interupts
     BK4819_WriteRegister(BK4819_REG_02, 0);
+
+    gBK4819_OperationWrites[BK4819_OP_FSK] = gBK4819_BusWrites - bus_writes;
 }
 
-void FSK_send_data(char * data, uint16_t len) {
-    memset(transit_buffer, 0, TRANSIT_BUFFER_SIZE);
+bool FSK_queue_data(char * data, uint16_t len, uint8_t holdoff_10ms) {
+    if(len == 0 || len > FSK_TX_FRAME_SIZE || tx_queue_count >= FSK_TX_QUEUE_SIZE)
+        return false;
+
+    FSKTxFrame * frame = &tx_queue[(tx_queue_head + tx_queue_count) % FSK_TX_QUEUE_SIZE];
+    memcpy(frame->data, data, len);
+    frame->len = len;
+    frame->holdoff_10ms = holdoff_10ms;
+    #ifdef ENABLE_APRS_DIGI
+        frame->repeat = 0;
+    #endif
+    tx_queue_count++;
+
+    return true;
+}
+
+#ifdef ENABLE_APRS_DIGI
+bool FSK_queue_repeat(char * data, uint16_t len) {
+    if(!FSK_queue_data(data, len, 0))
+        return false;
+
+    FSKTxFrame * frame = &tx_queue[(tx_queue_head + tx_queue_count - 1) % FSK_TX_QUEUE_SIZE];
+    frame->repeat = 1;
+    frame->heard_ms = rx_end_ms;
+
+    return true;
+}
+#endif
 
-    if( modem_status != READY) return;
+static void FSK_drop_frame() {
+    if(tx_queue_count == 0)
+        return;
+    tx_queue_head = (tx_queue_head + 1) % FSK_TX_QUEUE_SIZE;
+    tx_queue_count--;
+}
+
+/**
+ * Encodes the frame at the head of the queue into the transit buffer
+ *
+ * @return length of the encoded data, 0 if it can't be sent
+ */
+static uint16_t FSK_load_frame() {
+    const FSKTxFrame * frame = &tx_queue[tx_queue_head];
+    const char * data = frame->data;
+    uint16_t len = frame->len;
+    uint16_t encoded_len;
 
-    if(len == 0) return;
+    memset(transit_buffer, 0, TRANSIT_BUFFER_SIZE);
 
+    #ifdef ENABLE_APRS
+        // flags, FCS, bit stuffing and NRZI in a single pass, straight into the buffer
+        encoded_len = HDLC_frame(
+            data,
+            len,
+            transit_buffer,
+            TRANSIT_BUFFER_SIZE,
+            4 * NRZI_PREAMBLE,
+            gEeprom.FSK_CONFIG.data.nrzi,
+            nrzi_sync_state
+        );
+    #else
+    #ifdef ENABLE_MESSENGER_FEC
+        char fec_frame[FEC_ENCODED_SIZE(FSK_TX_FRAME_SIZE)];
+        if(gEeprom.FSK_CONFIG.data.fec) {
+            // parity goes on before NRZI, the receiver takes it off after
+            len = FEC_encode(data, len, fec_frame);
+            data = fec_frame;
+        }
+    #endif
     if(gEeprom.FSK_CONFIG.data.nrzi) {
         memcpy(transit_buffer + 4 * NRZI_PREAMBLE, data, len);
         // duplicate the sync bytes to increase chances of digital read lock
@@ -682,13 +686,53 @@ void FSK_send_data(char * data, uint16_t len) {
             transit_buffer[i*4 + 3] = (uint8_t)((_sync_23 >> 8) & 0xFF); // High byte of second sync word
         }
         FSK_encode_nrzi(transit_buffer, (4 * NRZI_PREAMBLE) + len, nrzi_sync_state);
+        encoded_len = (4 * NRZI_PREAMBLE) + len;
     } else {
         memcpy(transit_buffer, data, len);
+        encoded_len = len;
+    }
+    #endif
+
+    return encoded_len;
+}
+
+/**
+ * Loads the next frame into the modem and enables FSK TX. The FIFO can only
+ * be filled once the modem has had time to settle.
+ */
+static bool FSK_arm_frame() {
+    const uint16_t encoded_len = FSK_load_frame();
+    if(encoded_len == 0)
+        return false;
+
+    tx_index = 0;
+    transmit_len = FSK_set_data_length(encoded_len);
+
+    // Enable FSK TX
+    BK4819_FskEnableTx();
+
+    // this delay REALLY has to be here. Potentially replaceable with an interrupt wait but I don't know.
+    // if you don't wait, bytes in the FIFO will just not be properly understood by the modem
+    tx_countdown_10ms = 100 / 10;
+    tx_state = FSK_TX_ARMED;
+    return true;
+}
+
+static void FSK_fill_fifo(uint16_t words) {
+    for (uint16_t j = 0; tx_index < transmit_len && j < words; tx_index += 2, j++) {
+        if (tx_index + 1 < transmit_len) {
+            BK4819_WriteRegister(BK4819_REG_5F, (transit_buffer[tx_index + 1] << 8) | transit_buffer[tx_index]);
+        } else {
+            // Handle odd length by padding with zero
+            BK4819_WriteRegister(BK4819_REG_5F, 0x00 | transit_buffer[tx_index]);
+        }
     }
+}
 
+static bool FSK_key_up() {
     if(RADIO_GetVfoState() != VFO_STATE_NORMAL){
         gRequestDisplayScreen = DISPLAY_MAIN;
-        return;
+        return false;
     }
 
     FSK_disable_rx();
@@ -697,6 +741,14 @@ void FSK_send_data(char * data, uint16_t len) {
 
     RADIO_PrepareTX();
 
+    if(gCurrentFunction != FUNCTION_TRANSMIT) {
+        // TX not allowed, RADIO_PrepareTX already told the user why
+        modem_status = READY;
+        if(gEeprom.FSK_CONFIG.data.receive)
+            BK4819_FskEnableRx();
+        return false;
+    }
+
     RADIO_SetVfoState(VFO_STATE_NORMAL);
     BK4819_ToggleGpioOut(BK4819_GPIO6_PIN2_GREEN, false);
     BK4819_ToggleGpioOut(BK4819_GPIO5_PIN1_RED, true);
@@ -706,16 +758,44 @@ void FSK_send_data(char * data, uint16_t len) {
     // mute the mic during TX
     gMuteMic = true;
 
-    SYSTEM_DelayMs(50);
+    tx_countdown_10ms = 50 / 10;
+    tx_state = FSK_TX_KEYUP;
+    return true;
+}
 
+static const BK4819_RegisterWrite_t FSK_modulator_regs[] = {
+    // turn off CTCSS/CDCSS during FFSK
+    BK4819_REG_WRITE(BK4819_REG_51, 0),
 
-	// turn off CTCSS/CDCSS during FFSK
-	const uint16_t css_val = BK4819_ReadRegister(BK4819_REG_51);
-	BK4819_WriteRegister(BK4819_REG_51, 0);
+    // REG_2B   0
+    //
+    // <15> 1 Enable CTCSS/CDCSS DC cancellation after FM Demodulation   1 = enable 0 = disable
+    // <14> 1 Enable AF DC cancellation after FM Demodulation            1 = enable 0 = disable
+    // <10> 0 AF RX HPF 300Hz filter     0 = enable 1 = disable
+    // <9>  0 AF RX LPF 3kHz filter      0 = enable 1 = disable
+    // <8>  0 AF RX de-emphasis filter   0 = enable 1 = disable
+    // <2>  0 AF TX HPF 300Hz filter     0 = enable 1 = disable
+    // <1>  0 AF TX LPF filter           0 = enable 1 = disable
+    // <0>  0 AF TX pre-emphasis filter  0 = enable 1 = disable
+    //
+    // disable the 300Hz HPF and FM pre-emphasis filter
+    //
+    BK4819_REG_WRITE(BK4819_REG_2B, (1u << 2) | (1u << 0)),
 
-	// set the FM deviation level
-	const uint16_t dev_val = BK4819_ReadRegister(BK4819_REG_40);
+    // make sure we hear about the FIFO draining, even with RX off,
+    // the other interrupts stay as they are
+    BK4819_REG_UPDATE(BK4819_REG_3F,
+        BK4819_REG_3F_FSK_FIFO_ALMOST_EMPTY | BK4819_REG_3F_FSK_TX_FINISHED,
+        BK4819_REG_3F_FSK_FIFO_ALMOST_EMPTY | BK4819_REG_3F_FSK_TX_FINISHED),
+};
 
+static void FSK_setup_modulator() {
+	// what FSK_restore_modulator puts back once TX is over
+	css_val = BK4819_ReadRegister(BK4819_REG_51);
+	dev_val = BK4819_ReadRegister(BK4819_REG_40);
+	filt_val = BK4819_ReadRegister(BK4819_REG_2B);
+
+	// set the FM deviation level
 	{
 		uint16_t deviation;
 		switch (gEeprom.VfoInfo[gEeprom.TX_VFO].CHANNEL_BANDWIDTH)
@@ -732,93 +812,10 @@ void FSK_send_data(char * data, uint16_t len) {
 		BK4819_WriteRegister(BK4819_REG_40, (dev_val & 0xf000) | (deviation & 0xfff));
 	}
 
-	// REG_2B   0
-	//
-	// <15> 1 Enable CTCSS/CDCSS DC cancellation after FM Demodulation   1 = enable 0 = disable
-	// <14> 1 Enable AF DC cancellation after FM Demodulation            1 = enable 0 = disable
-	// <10> 0 AF RX HPF 300Hz filter     0 = enable 1 = disable
-	// <9>  0 AF RX LPF 3kHz filter      0 = enable 1 = disable
-	// <8>  0 AF RX de-emphasis filter   0 = enable 1 = disable
-	// <2>  0 AF TX HPF 300Hz filter     0 = enable 1 = disable
-	// <1>  0 AF TX LPF filter           0 = enable 1 = disable
-	// <0>  0 AF TX pre-emphasis filter  0 = enable 1 = disable
-	//
-	// disable the 300Hz HPF and FM pre-emphasis filter
-	//
-	const uint16_t filt_val = BK4819_ReadRegister(BK4819_REG_2B);
-	BK4819_WriteRegister(BK4819_REG_2B, (1u << 2) | (1u << 0));
-	
-    uint16_t transmit_len;
-    if(gEeprom.FSK_CONFIG.data.nrzi)
-        transmit_len = FSK_set_data_length((4 * NRZI_PREAMBLE) + len);
-    else
-        transmit_len = FSK_set_data_length(len);
-
-
-    // Enable FSK TX
-    BK4819_FskEnableTx();
-
-    // this delay REALLY has to be here. Potentially replaceable with an interrupt wait but I don't know.
-    // if you don't wait, bytes in the FIFO will just not be properly understood by the modem
-	SYSTEM_DelayMs(100);
-
-
-    uint16_t tx_index = 0;
-    for (uint16_t j = 0; tx_index < transmit_len && j < TX_FIFO_THRESHOLD; tx_index += 2, j++) {
-        if (tx_index + 1 < transmit_len) {
-            BK4819_WriteRegister(BK4819_REG_5F, (transit_buffer[tx_index + 1] << 8) | transit_buffer[tx_index]);
-        } else {
-            // Handle odd length by padding with zero
-            BK4819_WriteRegister(BK4819_REG_5F, 0x00 | transit_buffer[tx_index]);
-        }
-    }
-    do {
-        for (uint16_t j = 0; tx_index < transmit_len && j < TX_FIFO_SEGMENT; tx_index += 2, j++) {
-            if (tx_index + 1 < transmit_len) {
-                BK4819_WriteRegister(BK4819_REG_5F, (transit_buffer[tx_index + 1] << 8) | transit_buffer[tx_index]);
-            } else {
-                // Handle odd length by padding with zero
-                BK4819_WriteRegister(BK4819_REG_5F, 0x00 | transit_buffer[tx_index]);
-            }
-        }
-
-        // Allow up to 1s
-        uint16_t timeout = 1000 / 5;
-
-        while (timeout-- > 0)
-        {
-            SYSTEM_DelayMs(5);
-            uint16_t reg_0c = BK4819_ReadRegister(BK4819_REG_0C);
-            
-            if (reg_0c & (1u << 0))
-            {   // We have interrupt flags
-                uint16_t reg_02 = BK4819_ReadRegister(BK4819_REG_02);
-                
-                if (reg_02 & BK4819_REG_02_FSK_TX_FINISHED)
-                {
-                    reg_02 &= ~BK4819_REG_02_FSK_TX_FINISHED;
-                    break;
-                }
-                else if (reg_02 & (BK4819_REG_02_FSK_FIFO_ALMOST_EMPTY))
-                {
-                    reg_02 &= ~BK4819_REG_02_FSK_FIFO_ALMOST_EMPTY;
-                    break;
-                }
-                
-                // Clear only the flags we've handled
-                BK4819_WriteRegister(BK4819_REG_02, reg_02);
-            }
-        }
-
-        if(timeout == 0) // also exit if any segment timed out
-            break;
-
-    } while(tx_index < transmit_len);
-
-
-
-    SYSTEM_DelayMs(100);
+	BK4819_WriteRegisters(FSK_modulator_regs, ARRAY_SIZE(FSK_modulator_regs));
+}
 
+static void FSK_restore_modulator() {
 	// disable TX
     FSK_disable_tx();
 
@@ -830,12 +827,12 @@ void FSK_send_data(char * data, uint16_t len) {
 
 	// restore the CTCSS/CDCSS setting
 	BK4819_WriteRegister(BK4819_REG_51, css_val);
+}
 
-    SYSTEM_DelayMs(50);
-
-    APP_EndTransmission(false);
-
-    // this must be run after end of TX, otherwise radio will still TX transmit without even RED LED on
+/**
+ * Puts the modem back into RX once PTT has been dropped
+ */
+static void FSK_end_tx() {
     FUNCTION_Select(FUNCTION_FOREGROUND);
 
     RADIO_SetVfoState(VFO_STATE_NORMAL);
@@ -855,5 +852,104 @@ void FSK_send_data(char * data, uint16_t len) {
         FSK_set_data_length(RX_DATA_LENGTH);
     }
     modem_status = READY;
+    tx_state = FSK_TX_IDLE;
+}
+
+static void FSK_handle_tx_interrupt(const uint16_t interrupt_bits) {
+    if(tx_state != FSK_TX_STREAM)
+        return;
+
+    if (interrupt_bits & BK4819_REG_02_FSK_TX_FINISHED) {
+        // let the last bits leave the modem before cutting the carrier
+        tx_countdown_10ms = 100 / 10;
+        tx_state = FSK_TX_TAIL;
+    } else if (interrupt_bits & BK4819_REG_02_FSK_FIFO_ALMOST_EMPTY) {
+        FSK_fill_fifo(TX_FIFO_SEGMENT);
+        // Allow up to 1s per segment
+        tx_countdown_10ms = 1000 / 10;
+    }
 }
 
+#ifdef ENABLE_APRS_DIGI
+uint32_t FSK_repeat_latency_ms() {
+    return repeat_latency_ms;
+}
+#endif
+
+void FSK_tx_timeslice_10ms() {
+    if(tx_state >= FSK_TX_KEYUP && tx_state < FSK_TX_RELEASE && gCurrentFunction != FUNCTION_TRANSMIT) {
+        // TX was ended under our feet (timeout, PTT), give up on this frame
+        if(tx_state > FSK_TX_KEYUP)
+            FSK_restore_modulator();
+        FSK_drop_frame();
+        FSK_end_tx();
+        return;
+    }
+
+    if(tx_countdown_10ms > 0) {
+        tx_countdown_10ms--;
+        return;
+    }
+
+    switch(tx_state) {
+        case FSK_TX_IDLE:
+            if(tx_queue_count == 0)
+                break;
+            tx_countdown_10ms = tx_queue[tx_queue_head].holdoff_10ms;
+            tx_state = FSK_TX_HOLDOFF;
+            // no reason to lose a tick, e.g. when digipeating
+            if(tx_countdown_10ms > 0)
+                break;
+            [[fallthrough]];
+        case FSK_TX_HOLDOFF:
+            // never key up on top of a packet being received
+            if(modem_status != READY)
+                break;
+            if(!FSK_key_up()) {
+                FSK_drop_frame();
+                tx_state = FSK_TX_IDLE;
+            }
+            break;
+        case FSK_TX_KEYUP:
+            FSK_setup_modulator();
+            if(!FSK_arm_frame()) {
+                tx_countdown_10ms = 0;
+                tx_state = FSK_TX_TAIL;
+            }
+            break;
+        case FSK_TX_ARMED:
+            #ifdef ENABLE_APRS_DIGI
+                if(tx_queue[tx_queue_head].repeat)
+                    repeat_latency_ms = SYSTICK_GetMs() - tx_queue[tx_queue_head].heard_ms;
+            #endif
+            FSK_fill_fifo(TX_FIFO_THRESHOLD);
+            FSK_fill_fifo(TX_FIFO_SEGMENT);
+            // Allow up to 1s per segment
+            tx_countdown_10ms = 1000 / 10;
+            tx_state = FSK_TX_STREAM;
+            break;
+        case FSK_TX_STREAM:
+            // segment timed out
+            tx_state = FSK_TX_TAIL;
+            break;
+        case FSK_TX_TAIL:
+            FSK_drop_frame();
+            if(tx_queue_count > 0 && tx_queue[tx_queue_head].holdoff_10ms == 0) {
+                // more frames waiting, send them in the same key-up
+                FSK_disable_tx();
+                BK4819_FskClearFifo();
+                if(FSK_arm_frame())
+                    break;
+                FSK_drop_frame();
+            }
+            FSK_restore_modulator();
+            tx_countdown_10ms = 50 / 10;
+            tx_state = FSK_TX_RELEASE;
+            break;
+        case FSK_TX_RELEASE:
+            APP_EndTransmission(false);
+            // this must be run after end of TX, otherwise radio will still TX transmit without even RED LED on
+            FSK_end_tx();
+            break;
+    }
+}
@@ -19,10 +19,27 @@
 #ifndef FSK_H
 #define FSK_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
+#ifdef ENABLE_APRS
+  #include "app/ax25.h"
+#endif
+
+#if defined(ENABLE_MESSENGER_FEC) && defined(ENABLE_APRS)
+  #error "ENABLE_MESSENGER_FEC is for the plain messenger frames, AX.25 has to stay plain HDLC"
+#endif
+
 #define TRANSIT_BUFFER_SIZE 512
 
+// frames waiting to go out, copied so the caller can reuse its buffer
+#define FSK_TX_QUEUE_SIZE 3
+#ifdef ENABLE_APRS
+  #define FSK_TX_FRAME_SIZE (AX25_IFRAME_MAX_SIZE)
+#else
+  #define FSK_TX_FRAME_SIZE 64
+#endif
+
 // MessengerConfig                            // 2024 kamilsss655
 typedef union {
   struct {
@@ -30,7 +47,8 @@ typedef union {
       receive    :1, // determines whether fsk modem will listen for new messages
       modulation :2, // determines FSK modulation type
       nrzi       :1, // uses NRZI encoding for bits
-      unused     :5;
+      fec        :1, // adds Reed-Solomon parity to every frame, see app/fec.h
+      unused     :3;
   } data;
   uint8_t __val;
 } FSKConfig;
@@ -60,7 +78,31 @@ void FSK_init(
 );
 void FSK_configure();
 void FSK_disable_rx();
-void FSK_send_data(char * data, uint16_t len);
+/**
+ * Queues a frame for transmission and returns straight away. The frame is
+ * sent from FSK_tx_timeslice_10ms, together with any other frame queued
+ * behind it without a holdoff.
+ *
+ * @param holdoff_10ms Time to wait before keying up, e.g. to let the other
+ *                     station get back to RX
+ * @return false if the frame is too long or the queue is full
+ */
+bool FSK_queue_data(char * data, uint16_t len, uint8_t holdoff_10ms);
+#ifdef ENABLE_APRS_DIGI
+/**
+ * Queues the frame just received for repeating, without a holdoff. Its
+ * latency counts from the closing flag of the frame as it came in.
+ *
+ * @return false if the frame is too long or the queue is full
+ */
+bool FSK_queue_repeat(char * data, uint16_t len);
+/**
+ * Time from the end of RX of the frame repeated last to its first bits
+ * going into the FIFO
+ */
+uint32_t FSK_repeat_latency_ms();
+#endif
+void FSK_tx_timeslice_10ms();
 void FSK_store_packet_interrupt(const uint16_t interrupt_bits);
 void FSK_end_rx();
 
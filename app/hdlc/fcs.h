@@ -5,6 +5,8 @@
 #ifndef FCS_H
 #define FCS_H
 
+#include <stdint.h>
+
 #ifdef CRC32
     #define FCS_INIT_VALUE 0xFFFFFFFF /* FCS initialization value. */
     #define FCS_GOOD_VALUE 0xDEBB20E3 /* FCS value for valid frames. */
@@ -0,0 +1,195 @@
+#include <stdint.h>
+#include <stddef.h>
+
+#include "app/hdlc/hdlc.h"
+
+void HDLC_deframer_init(HDLCDeframer * self, void (*frame_callback)(char*, uint16_t), uint8_t nrzi) {
+    self->frame_callback = frame_callback;
+    self->nrzi = nrzi;
+    HDLC_deframer_reset(self, 1);
+}
+
+void HDLC_deframer_reset(HDLCDeframer * self, uint8_t level) {
+    self->status = HDLC_HUNT;
+    self->level = level;
+    self->shift = 0;
+    self->ones = 0;
+    self->octet = 0;
+    self->bit_count = 0;
+    self->len = 0;
+    self->fcs = FCS_INIT_VALUE;
+}
+
+static void HDLC_open_frame(HDLCDeframer * self) {
+    self->status = HDLC_FRAME;
+    self->ones = 0;
+    self->octet = 0;
+    self->bit_count = 0;
+    self->len = 0;
+    self->fcs = FCS_INIT_VALUE;
+}
+
+/**
+ * Runs a single decoded bit through flag hunting, de-stuffing and
+ * FCS accumulation.
+ *
+ * @returns 1 if a complete frame was delivered
+ */
+static uint8_t HDLC_deframer_bit(HDLCDeframer * self, uint8_t bit) {
+    uint8_t delivered = 0;
+
+    self->shift = (self->shift >> 1) | (bit << 7);
+
+    if (self->shift == HDLC_FLAG) {
+        // the first seven bits of the flag were collected as data, so a
+        // frame made of whole octets always leaves exactly seven behind
+        if (self->status == HDLC_FRAME &&
+            self->bit_count == 7 &&
+            self->len >= HDLC_MIN_FRAME_SIZE &&
+            self->fcs == FCS_GOOD_VALUE) {
+            if (self->frame_callback)
+                self->frame_callback(self->buffer, self->len - 2);
+            delivered = 1;
+        }
+        // a closing flag may also open the next frame
+        HDLC_open_frame(self);
+        return delivered;
+    }
+
+    if ((self->shift & 0xFE) == 0xFE) {
+        // seven ones in a row: abort sequence or noise
+        self->status = HDLC_HUNT;
+        return 0;
+    }
+
+    if (self->status == HDLC_HUNT)
+        return 0;
+
+    if (bit) {
+        self->ones++;
+    } else {
+        const uint8_t stuffed = self->ones == 5;
+        self->ones = 0;
+        if (stuffed)
+            return 0;
+    }
+
+    self->octet = (self->octet >> 1) | (bit << 7);
+    if (++self->bit_count < 8)
+        return 0;
+
+    if (self->len >= HDLC_RX_BUFFER_SIZE) {
+        // too long to be ours, wait for the next flag
+        self->status = HDLC_HUNT;
+        return 0;
+    }
+
+    self->buffer[self->len++] = self->octet;
+    self->fcs = calc_fcs(self->fcs, self->octet);
+    self->bit_count = 0;
+
+    return 0;
+}
+
+uint8_t HDLC_deframer_push(HDLCDeframer * self, uint16_t word) {
+    uint8_t delivered = 0;
+
+    // low byte goes first on air, each byte MSB first
+    for (uint8_t i = 0; i < 2; i++, word >>= 8) {
+        uint8_t byte = word & 0xFF;
+        if (self->nrzi)
+            byte = HDLC_nrzi_decode(byte, &self->level);
+
+        for (int8_t bit_idx = 7; bit_idx >= 0; bit_idx--)
+            delivered += HDLC_deframer_bit(self, (byte >> bit_idx) & 0x01);
+    }
+
+    return delivered;
+}
+
+/*
+ * Bit stuffing, a nibble at a time. Indexed by the number of ones already
+ * sent in a row and by the nibble, first bit on air in bit 0. Each entry is
+ * laid out as:
+ *
+ *  <10:8> ones in a row after the nibble
+ *  < 7:5> number of bits to send, 4 or 5 when a zero had to be inserted
+ *  < 4:0> bits to send, first one in the highest used position
+ */
+static const uint16_t stuff_table[5][16] = {
+    {0x080, 0x088, 0x084, 0x08C, 0x082, 0x08A, 0x086, 0x08E, 0x181, 0x189, 0x185, 0x18D, 0x283, 0x28B, 0x387, 0x48F},
+    {0x080, 0x088, 0x084, 0x08C, 0x082, 0x08A, 0x086, 0x08E, 0x181, 0x189, 0x185, 0x18D, 0x283, 0x28B, 0x387, 0x0BE},
+    {0x080, 0x088, 0x084, 0x08C, 0x082, 0x08A, 0x086, 0x0BC, 0x181, 0x189, 0x185, 0x18D, 0x283, 0x28B, 0x387, 0x1BD},
+    {0x080, 0x088, 0x084, 0x0B8, 0x082, 0x08A, 0x086, 0x0BA, 0x181, 0x189, 0x185, 0x1B9, 0x283, 0x28B, 0x387, 0x2BB},
+    {0x080, 0x0B0, 0x084, 0x0B4, 0x082, 0x0B2, 0x086, 0x0B6, 0x181, 0x1B1, 0x185, 0x1B5, 0x283, 0x2B3, 0x387, 0x3B7},
+};
+
+typedef struct {
+    char * dest;
+    uint16_t size;
+    uint16_t len;
+    uint16_t acc;    // bits waiting to be written, last one on air in bit 0
+    uint8_t count;   // number of bits waiting in acc
+    uint8_t ones;    // ones sent in a row, for stuffing
+    uint8_t nrzi;
+    uint8_t level;
+} HDLCFramer;
+
+static void HDLC_put_bits(HDLCFramer * self, uint8_t bits, uint8_t count) {
+    self->acc = (self->acc << count) | bits;
+    self->count += count;
+    if (self->count < 8)
+        return;
+
+    self->count -= 8;
+    uint8_t byte = self->acc >> self->count;
+    if (self->nrzi)
+        byte = HDLC_nrzi_encode(byte, &self->level);
+    if (self->len < self->size)
+        self->dest[self->len] = byte;
+    self->len++;
+}
+
+static void HDLC_put_flag(HDLCFramer * self) {
+    HDLC_put_bits(self, HDLC_FLAG, 8);
+    self->ones = 0;
+}
+
+static void HDLC_put_octet(HDLCFramer * self, uint8_t octet) {
+    // AX.25 octets go least significant bit first
+    for (uint8_t i = 0; i < 2; i++, octet >>= 4) {
+        const uint16_t entry = stuff_table[self->ones][octet & 0x0F];
+        HDLC_put_bits(self, entry & 0x1F, (entry >> 5) & 0x07);
+        self->ones = entry >> 8;
+    }
+}
+
+uint16_t HDLC_frame(const char * src, uint16_t len, char * dest, uint16_t dest_size, uint8_t flags, uint8_t nrzi, uint8_t level) {
+    HDLCFramer framer = {
+        .dest = dest,
+        .size = dest_size,
+        .nrzi = nrzi,
+        .level = level,
+    };
+    FCS_SIZE fcs = FCS_INIT_VALUE;
+
+    while (flags--)
+        HDLC_put_flag(&framer);
+
+    for (uint16_t i = 0; i < len; i++) {
+        fcs = calc_fcs(fcs, src[i]);
+        HDLC_put_octet(&framer, src[i]);
+    }
+
+    fcs ^= FCS_INVERT_MASK;
+    HDLC_put_octet(&framer, fcs & 0xFF);
+    HDLC_put_octet(&framer, fcs >> 8);
+
+    HDLC_put_flag(&framer);
+
+    // fill up the last byte with the start of another flag
+    if (framer.count)
+        HDLC_put_bits(&framer, HDLC_FLAG >> framer.count, 8 - framer.count);
+
+    return framer.len <= dest_size ? framer.len : 0;
+}
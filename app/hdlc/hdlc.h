@@ -0,0 +1,106 @@
+/**
+ * @file hdlc.h
+ *
+ * Bit-level HDLC framing for AX.25 over the BK4819 FSK FIFO.
+ *
+ * Bits are taken from each FIFO word the same way the rest of the modem
+ * code does: low byte first, most significant bit first within each byte.
+ * AX.25 octets travel least significant bit first, so octets are assembled
+ * from the bottom up.
+ */
+
+#ifndef HDLC_H
+#define HDLC_H
+
+#include <stdint.h>
+
+#include "app/ax25.h"
+#include "fcs.h"
+
+#define HDLC_FLAG 0x7E
+
+/** Smallest frame worth handing over: two addresses, control and FCS */
+#define HDLC_MIN_FRAME_SIZE (CALLSIGN_SIZE + CALLSIGN_SIZE + 1 + 2)
+
+/** Frame plus its two FCS bytes */
+#define HDLC_RX_BUFFER_SIZE (AX25_IFRAME_MAX_SIZE + 2)
+
+/**
+ * NRZI encodes one on-air byte (MSB first), where '0' toggles the line
+ * and '1' keeps it. The line level is a prefix XOR of the toggles, so the
+ * whole byte is done with three shifts instead of a branch per bit.
+ *
+ * @param level Line level before the byte, updated to the level after it
+ */
+static inline uint8_t HDLC_nrzi_encode(uint8_t byte, uint8_t * level) {
+    uint8_t toggles = ~byte;
+    toggles ^= toggles >> 1;
+    toggles ^= toggles >> 2;
+    toggles ^= toggles >> 4;
+    const uint8_t encoded = *level ? (uint8_t)~toggles : toggles;
+    *level = encoded & 0x01;
+    return encoded;
+}
+
+/**
+ * Inverse of HDLC_nrzi_encode: a bit equal to the one before it is a '1'.
+ */
+static inline uint8_t HDLC_nrzi_decode(uint8_t byte, uint8_t * level) {
+    const uint8_t previous = (byte >> 1) | (*level << 7);
+    *level = byte & 0x01;
+    return ~(byte ^ previous);
+}
+
+typedef enum HDLCRxStatus {
+    HDLC_HUNT,   // waiting for an opening flag
+    HDLC_FRAME,  // collecting octets between flags
+} HDLCRxStatus;
+
+typedef struct {
+    void (*frame_callback)(char*, uint16_t);
+    FCS_SIZE fcs;
+    uint16_t len;
+    uint8_t status;
+    uint8_t nrzi;       // bits on air are NRZI encoded
+    uint8_t level;      // last line level, for NRZI decoding
+    uint8_t shift;      // last 8 decoded bits, for flag detection
+    uint8_t ones;       // consecutive ones, for de-stuffing
+    uint8_t octet;      // octet under assembly
+    uint8_t bit_count;  // bits collected into octet
+    char buffer[HDLC_RX_BUFFER_SIZE];
+} HDLCDeframer;
+
+/**
+ * Sets up a deframer. Every frame with a valid FCS is handed to
+ * [frame_callback] as soon as its closing flag is seen, without the FCS.
+ */
+void HDLC_deframer_init(HDLCDeframer * self, void (*frame_callback)(char*, uint16_t), uint8_t nrzi);
+
+/**
+ * Drops any partial frame and starts hunting for a flag.
+ *
+ * @param level Line level the NRZI decoder should assume for the previous bit
+ */
+void HDLC_deframer_reset(HDLCDeframer * self, uint8_t level);
+
+/**
+ * Feeds one 16-bit word read from REG_5F.
+ *
+ * @returns the number of frames delivered while consuming the word
+ */
+uint8_t HDLC_deframer_push(HDLCDeframer * self, uint16_t word);
+
+/**
+ * Turns a raw frame into on-air bytes in one pass: opening flags, the
+ * frame, its FCS and a closing flag, bit stuffed and optionally NRZI
+ * encoded. Stuffing and NRZI go through nibble and byte wide tricks
+ * rather than a loop per bit. Bytes come out in FIFO order, so pairs
+ * of them can be written to REG_5F low byte first.
+ *
+ * @param flags Number of opening flags, doubling as preamble
+ * @param level Line level the NRZI encoder starts from
+ * @returns number of bytes written to dest, 0 if they don't fit
+ */
+uint16_t HDLC_frame(const char * src, uint16_t len, char * dest, uint16_t dest_size, uint8_t flags, uint8_t nrzi, uint8_t level);
+
+#endif
@@ -0,0 +1,210 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <string.h>
+
+#include "app/fsk.h"
+#include "app/kiss.h"
+#include "driver/uart.h"
+#include "external/printf/printf.h"
+
+#if !defined(ENABLE_APRS) || !defined(ENABLE_UART)
+	#error "the KISS TNC passes AX.25 frames over the UART"
+#endif
+
+#define KISS_FEND            0xC0
+#define KISS_FESC            0xDB
+#define KISS_TFEND           0xDC
+#define KISS_TFESC           0xDD
+
+#define KISS_CMD_DATA        0x00
+#define KISS_CMD_RETURN      0xFF
+
+// enough for a few APRS frames, escaping included
+#define KISS_HOST_BUFFER_SIZE 512
+
+static bool     gActive;
+
+// frame from the host, command byte first
+static char     gFrame[1 + FSK_TX_FRAME_SIZE];
+static uint16_t gFrameLength;
+static bool     gEscaped;
+static bool     gOverflow;
+
+// frames from the host that never went on air, reported by "KISS?"
+static uint16_t gQueued;
+static uint16_t gDroppedFull;  // TX queue had no room
+static uint16_t gDroppedLong;  // longer than an AX.25 frame can be
+static uint16_t gDroppedHost;  // heard on air, no room in gHostBuffer
+
+// frames for the host, KISS encoded, drained as the UART FIFO has room
+static uint8_t  gHostBuffer[KISS_HOST_BUFFER_SIZE];
+static uint16_t gHostHead;
+static uint16_t gHostTail;
+
+void KISS_Start(void)
+{
+	gActive      = true;
+	gFrameLength = 0;
+	gEscaped     = false;
+	gOverflow    = false;
+	gHostHead    = 0;
+	gHostTail    = 0;
+}
+
+bool KISS_IsActive(void)
+{
+	return gActive;
+}
+
+static void KISS_EndFrame(void)
+{
+	if (gOverflow)
+		gDroppedLong++;
+	else
+	if (gFrameLength > 0)
+	{
+		const uint8_t Command = gFrame[0];
+
+		if (Command == KISS_CMD_RETURN)
+			gActive = false;
+		else
+		if (Command == KISS_CMD_DATA && gFrameLength > 1)
+		{	// frames queued back to back go out in the same key-up, there is
+			// nowhere to hold one back while the queue is full, the UART ring
+			// has to keep moving or the DMA overwrites frames still in it
+			if (FSK_queue_data(gFrame + 1, gFrameLength - 1, 0))
+				gQueued++;
+			else
+				gDroppedFull++;
+		}
+		// TXDELAY, persistence and the like have no use here
+	}
+
+	gFrameLength = 0;
+	gEscaped  = false;
+	gOverflow = false;
+}
+
+void KISS_Feed(uint8_t Byte)
+{
+	if (Byte == KISS_FEND)
+	{
+		KISS_EndFrame();
+		return;
+	}
+
+	if (gEscaped)
+	{
+		gEscaped = false;
+		if (Byte == KISS_TFEND)
+			Byte = KISS_FEND;
+		else
+		if (Byte == KISS_TFESC)
+			Byte = KISS_FESC;
+	}
+	else
+	if (Byte == KISS_FESC)
+	{
+		gEscaped = true;
+		return;
+	}
+
+	if (gFrameLength < sizeof(gFrame))
+		gFrame[gFrameLength++] = Byte;
+	else
+		gOverflow = true;
+}
+
+static void KISS_Put(uint16_t *pHead, uint8_t Byte)
+{
+	gHostBuffer[*pHead] = Byte;
+	*pHead = (*pHead + 1) % KISS_HOST_BUFFER_SIZE;
+}
+
+void KISS_SendFrame(const char *pFrame, uint16_t Length)
+{
+	uint16_t Needed = 3;
+	uint16_t Free;
+	uint16_t Head;
+	uint16_t i;
+
+	if (!gActive)
+		return;
+
+	for (i = 0; i < Length; i++)
+		Needed += ((uint8_t)pFrame[i] == KISS_FEND || (uint8_t)pFrame[i] == KISS_FESC) ? 2 : 1;
+
+	// one byte stays unused so a full buffer doesn't look empty
+	Free = (gHostTail + KISS_HOST_BUFFER_SIZE - gHostHead - 1) % KISS_HOST_BUFFER_SIZE;
+	if (Needed > Free)
+	{
+		gDroppedHost++;
+		return;
+	}
+
+	Head = gHostHead;
+	KISS_Put(&Head, KISS_FEND);
+	KISS_Put(&Head, KISS_CMD_DATA);
+	for (i = 0; i < Length; i++)
+	{
+		const uint8_t Byte = pFrame[i];
+
+		if (Byte == KISS_FEND)
+		{
+			KISS_Put(&Head, KISS_FESC);
+			KISS_Put(&Head, KISS_TFEND);
+		}
+		else
+		if (Byte == KISS_FESC)
+		{
+			KISS_Put(&Head, KISS_FESC);
+			KISS_Put(&Head, KISS_TFESC);
+		}
+		else
+			KISS_Put(&Head, Byte);
+	}
+	KISS_Put(&Head, KISS_FEND);
+
+	gHostHead = Head;
+}
+
+void KISS_TimeSlice10ms(void)
+{
+	if (!gActive)
+		return;
+
+	// as much as the UART FIFO takes, it empties long before the next tick
+	while (gHostTail != gHostHead)
+	{
+		const uint16_t End  = (gHostHead > gHostTail) ? gHostHead : KISS_HOST_BUFFER_SIZE;
+		const uint32_t Sent = UART_SendSome(gHostBuffer + gHostTail, End - gHostTail);
+
+		if (Sent == 0)
+			break;
+
+		gHostTail = (gHostTail + Sent) % KISS_HOST_BUFFER_SIZE;
+	}
+}
+
+void KISS_Report(void)
+{
+	char      Line[64];
+	const int Length = snprintf(Line, sizeof(Line), "KISS tx %u full %u long %u rx-dropped %u\r\n",
+		gQueued, gDroppedFull, gDroppedLong, gDroppedHost);
+
+	UART_Send(Line, Length);
+}
@@ -0,0 +1,44 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef APP_KISS_H
+#define APP_KISS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// KISS TNC on UART1. Once the host sends "KISS" the UART carries nothing but
+// KISS frames: data frames for port 0 go out over the air through the FSK TX
+// queue, AX.25 frames heard come back to the host as data frames. The host
+// leaves KISS mode with a return frame (C0 FF C0).
+
+void KISS_Start(void);
+bool KISS_IsActive(void);
+
+// takes the next byte from the host, a frame that ends while the TX queue
+// is full is dropped and counted
+void KISS_Feed(uint8_t Byte);
+
+// queues a frame heard on air for the host, dropped if the buffer is full
+void KISS_SendFrame(const char *pFrame, uint16_t Length);
+
+// feeds the UART without waiting on it
+void KISS_TimeSlice10ms(void);
+
+// sends the frame and drop counts, for the "KISS?" query
+void KISS_Report(void);
+
+#endif
@@ -24,6 +24,9 @@
 #if !defined(ENABLE_OVERLAY)
 	#include "ARMCM0.h"
 #endif
+#ifdef ENABLE_APRS_DIGI
+	#include "app/digi.h"
+#endif
 #include "app/dtmf.h"
 #include "app/generic.h"
 #include "app/menu.h"
@@ -257,6 +260,9 @@ int MENU_GetLimits(uint8_t menu_id, int32_t *pMin, int32_t *pMax)
 		case MENU_MSG_RX:
 		case MENU_MSG_ACK:
 		case MENU_MSG_NRZI:
+#endif
+#ifdef ENABLE_MESSENGER_FEC
+		case MENU_MSG_FEC:
 #endif
 			*pMin = 0;
 			*pMax = ARRAY_SIZE(gSubMenu_OFF_ON) - 1;
@@ -269,6 +275,13 @@ int MENU_GetLimits(uint8_t menu_id, int32_t *pMin, int32_t *pMax)
 			break;
 #endif
 
+#ifdef ENABLE_APRS_DIGI
+		case MENU_APRS_DIGI:
+			*pMin = 0;
+			*pMax = DIGI_MAX_HOPS;
+			break;
+#endif
+
 		case MENU_AM:
 			*pMin = 0;
 			*pMax = ARRAY_SIZE(gModulationStr) - 1;
@@ -558,6 +571,18 @@ void MENU_AcceptSetting(void)
 				break;
 		#endif
 
+		#ifdef ENABLE_MESSENGER_FEC
+			case MENU_MSG_FEC:
+				gEeprom.FSK_CONFIG.data.fec = gSubMenuSelection;
+				break;
+		#endif
+
+		#ifdef ENABLE_APRS_DIGI
+			case MENU_APRS_DIGI:
+				gEeprom.MESSENGER_CONFIG.data.digi = gSubMenuSelection;
+				break;
+		#endif
+
 		case MENU_W_N:
 			gTxVfo->CHANNEL_BANDWIDTH = gSubMenuSelection;
 			gRequestSaveChannel       = 1;
@@ -1009,6 +1034,18 @@ void MENU_ShowCurrentSetting(void)
 				break;
 		#endif
 
+		#ifdef ENABLE_MESSENGER_FEC
+			case MENU_MSG_FEC:
+				gSubMenuSelection = gEeprom.FSK_CONFIG.data.fec;
+				break;
+		#endif
+
+		#ifdef ENABLE_APRS_DIGI
+			case MENU_APRS_DIGI:
+				gSubMenuSelection = gEeprom.MESSENGER_CONFIG.data.digi;
+				break;
+		#endif
+
 		#ifdef ENABLE_PWRON_PASSWORD
 			case MENU_PASSWORD:
 				gSubMenuSelection = gEeprom.POWER_ON_PASSWORD;
@@ -1691,6 +1728,8 @@ static void MENU_Key_MENU(const bool bKeyPressed, const bool bKeyHeld)
 
 						MENU_AcceptSetting();
 
+						EEPROM_Flush();
+
 						#if defined(ENABLE_OVERLAY)
 							overlay_FLASH_RebootToBootloader();
 						#else
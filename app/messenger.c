@@ -17,6 +17,7 @@
  *     limitations under the License.
  */
 
+#include <stdlib.h>
 #include <string.h>
 #include "driver/keyboard.h"
 #include "driver/st7565.h"
@@ -45,6 +46,12 @@
 	#include "app/nunu.h"
 #endif
 #include "app/fsk.h"
+#ifdef ENABLE_KISS
+	#include "app/kiss.h"
+#endif
+#ifdef ENABLE_APRS_DIGI
+	#include "app/digi.h"
+#endif
 
 const uint8_t MSG_BUTTON_STATE_HELD = 1 << 1;
 
@@ -55,6 +62,9 @@ const uint8_t MAX_MSG_LENGTH = MESSAGE_LENGTH - 1;
 
 #define NEXT_CHAR_DELAY 100 // 10ms tick
 
+// wait so the correspondent radio can properly receive the ack
+#define ACK_HOLDOFF_10MS 70
+
 char T9TableLow[9][4] = { {',', '.', '?', '!'}, {'a', 'b', 'c', '\0'}, {'d', 'e', 'f', '\0'}, {'g', 'h', 'i', '\0'}, {'j', 'k', 'l', '\0'}, {'m', 'n', 'o', '\0'}, {'p', 'q', 'r', 's'}, {'t', 'u', 'v', '\0'}, {'w', 'x', 'y', 'z'} };
 char T9TableUp[9][4] = { {',', '.', '-', ':'}, {'A', 'B', 'C', '\0'}, {'D', 'E', 'F', '\0'}, {'G', 'H', 'I', '\0'}, {'J', 'K', 'L', '\0'}, {'M', 'N', 'O', '\0'}, {'P', 'Q', 'R', 'S'}, {'T', 'U', 'V', '\0'}, {'W', 'X', 'Y', 'Z'} };
 unsigned char numberOfLettersAssignedToKey[9] = { 4, 3, 3, 3, 3, 3, 4, 3, 4 };
@@ -92,12 +102,52 @@ void moveUP(char (*rxMessages)[MESSAGE_LENGTH + 2]) {
 	memset(rxMessages[3], 0, sizeof(rxMessages[3]));
 }
 
-void MSG_SendPacket(char * packet, uint16_t len) {
+#ifdef ENABLE_APRS
+// in front of sent lines, indexed by APRSDelivery
+static const char delivery_marker[] = { ' ', '~', '+', '!', 'x' };
+
+// sent lines read "~101> text", the marker is swapped as the state changes
+static void MSG_ShowDelivery(const APRSOutbound * message) {
+	for (uint8_t i = 0; i < 4; i++) {
+		const char * line = rxMessage[i];
+		if (line[0] == 0 || memchr(delivery_marker, line[0], sizeof(delivery_marker)) == NULL)
+			continue;
+		if (atoi(line + 1) == message->id)
+			rxMessage[i][0] = delivery_marker[message->state];
+	}
 
-	if(len > 0) {
-		FSK_send_data(packet, len);
+	#ifdef ENABLE_MESSENGER_DELIVERY_NOTIFICATION
+		#ifdef ENABLE_MESSENGER_UART
+			if (message->state == APRS_DELIVERY_ACKED)
+				UART_printf("SVC<RCPT\r\n");
+		#endif
+		gUpdateStatus = true;
+	#endif
+	gUpdateDisplay = true;
+}
 
-	} else {
+static void MSG_SendOutbound(APRSOutbound * message) {
+	// with the TX queue full it stays due and is tried on the next slice
+	const uint16_t len = APRS_prepare_outbound(&ax25frame, message);
+	if (FSK_queue_data(ax25frame.raw_buffer, len, 0))
+		APRS_outbox_sent(message);
+}
+
+void MSG_TimeSlice500ms(void) {
+	APRSOutbound * message = APRS_outbox_timeslice_500ms();
+	if (message == NULL)
+		return;
+
+	if (message->state == APRS_DELIVERY_PENDING)
+		MSG_SendOutbound(message);
+	else
+		MSG_ShowDelivery(message);   // out of retries
+}
+#endif
+
+void MSG_SendPacket(char * packet, uint16_t len) {
+
+	if(!FSK_queue_data(packet, len, 0)) {
 		AUDIO_PlayBeep(BEEP_500HZ_60MS_DOUBLE_BEEP_OPTIONAL);
 	}
 }
@@ -138,75 +188,96 @@ void MSG_Init() {
 }
 
 #ifdef ENABLE_APRS
-void MSG_SendAck(uint16_t ack_id) {
+void MSG_SendAck(uint16_t ack_id, const char * to_callsign) {
 #else
 void MSG_SendAck() {
 #endif
 	// in the future we might reply with received payload and then the sending radio
 	// could compare it and determine if the messegage was read correctly (kamilsss655)
 	#ifdef ENABLE_APRS
-		char origin_callsign[CALLSIGN_SIZE + 1];
-		origin_callsign[CALLSIGN_SIZE] = 0;
-		strncpy(origin_callsign, ax25frame.raw_buffer + 1, CALLSIGN_SIZE);
-
-		APRS_prepare_ack(&ax25frame, ack_id, origin_callsign);
-		MSG_SendPacket(ax25frame.raw_buffer, ax25frame.len);
+		APRS_prepare_ack(&ax25frame, ack_id, to_callsign);
+		FSK_queue_data(ax25frame.raw_buffer, ax25frame.len, ACK_HOLDOFF_10MS);
 	#else
 		NUNU_prepare_ack(&dataPacket);
-		MSG_SendPacket(
+		FSK_queue_data(
 			dataPacket.serializedArray,
-			strlen(dataPacket.serializedArray)
+			strlen(dataPacket.serializedArray),
+			ACK_HOLDOFF_10MS
 		);
 	#endif
 }
 
 void MSG_HandleReceive(char * receive_buffer, uint16_t len) {
-	
+	#ifdef ENABLE_KISS
+		// as a TNC every frame goes to the host, which does the rest
+		if (KISS_IsActive()) {
+			KISS_SendFrame(receive_buffer, len);
+			return;
+		}
+	#endif
 
 	#ifdef ENABLE_APRS
-		uint8_t send_ack = 0;
-		uint8_t valid = APRS_parse(&ax25frame, receive_buffer, len);
+		// the view points straight into receive_buffer, nothing is copied
+		AX25View frame;
+		if (!APRS_parse(&frame, receive_buffer, len))
+			return;
+		const APRSType type = APRS_get_type(&frame);
+
+		// copies over other digipeaters are shown once, and acked once per
+		// window so a sender retrying because our ack got lost still gets one
+		#ifdef ENABLE_APRS_DIGI
+			const uint32_t heard = APRS_dupe_check(&frame);
+			// first thing, the sooner it is queued the sooner it goes out
+			DIGI_repeat(receive_buffer, &frame, heard);
+		#else
+			const uint32_t heard = type == APRS_TYPE_MESSAGE ? APRS_dupe_check(&frame) : APRS_DUPE_NEVER;
+		#endif
+
+		// acks and rejects only settle what we sent
+		if (type == APRS_TYPE_ACK || type == APRS_TYPE_REJECT) {
+			const APRSOutbound * message = APRS_outbox_ack(&frame);
+			if (message != NULL)
+				MSG_ShowDelivery(message);
+			return;
+		}
+
+		// positions, weather and the like are of no use to the messenger
+		uint8_t valid = type == APRS_TYPE_MESSAGE && heard == APRS_DUPE_NEVER;
 	#else
 		uint8_t valid = NUNU_parse(&dataPacket, receive_buffer, len);
 	#endif
 
 	if(!valid) {
-		NUNU_display_received(&dataPacket, rxMessage[3]); //FIXME: DEBUG :ERASE THIS
+		#ifndef ENABLE_APRS
+			NUNU_display_received(&dataPacket, rxMessage[3]); //FIXME: DEBUG :ERASE THIS
+		#endif
 		// snprintf(rxMessage[3], MESSAGE_LENGTH + 2, "ERROR: INVALID PACKET."); //FIXME: UNCOMMENT
 	} else {
 		moveUP(rxMessage);
-		#ifdef ENABLE_APRS
-			if (APRS_is_ack_for_message(&ax25frame, msg_id)) {
-				send_ack = 1;
-		#else
+		#ifndef ENABLE_APRS
 			if (dataPacket.data.header == ACK_PACKET) {
-		#endif
-			#ifdef ENABLE_MESSENGER_DELIVERY_NOTIFICATION
-				#ifdef ENABLE_MESSENGER_UART
-					UART_printf("SVC<RCPT\r\n");
+				#ifdef ENABLE_MESSENGER_DELIVERY_NOTIFICATION
+					#ifdef ENABLE_MESSENGER_UART
+						UART_printf("SVC<RCPT\r\n");
+					#endif
+					rxMessage[3][0] = '+';
+					gUpdateStatus = true;
+					gUpdateDisplay = true;
 				#endif
-				rxMessage[3][0] = '+';
-				gUpdateStatus = true;
-				gUpdateDisplay = true;
-			#endif
-		}
-		else
+			}
+			else
+		#endif
 		{
 			#ifdef ENABLE_APRS
-				APRS_display_received(&ax25frame, rxMessage[3]);
+				APRS_display_received(&frame, rxMessage[3]);
 			#else
 				NUNU_display_received(&dataPacket, rxMessage[3]);
 			#endif
 			#ifdef ENABLE_MESSENGER_UART
 				#ifdef ENABLE_APRS
-					uint8_t buf[PAYLOAD_LENGTH + 8];
-					snprintf(
-						buf,
-						ax25frame.fcs_offset - ax25frame.control_offset,
-						"APRS<%s\r\n",
-						ax25frame.buffer + ax25frame.control_offset + 1
-					);
-					UART_Send(buf, sizeof(buf));
+					UART_Send("APRS<", 5);
+					UART_Send(AX25_info(&frame), AX25_info_len(&frame));
+					UART_Send("\r\n", 2);
 				#else
 					UART_printf("SMS<%s\r\n", dataPacket.data.payload);
 				#endif
@@ -229,18 +300,20 @@ void MSG_HandleReceive(char * receive_buffer, uint16_t len) {
 	// Transmit a message to the sender that we have received the message
 	if(gEeprom.MESSENGER_CONFIG.data.ack) {
 		#ifdef ENABLE_APRS
-			uint16_t ack_id = APRS_get_msg_id(&ax25frame);
-			if(send_ack && ack_id)
+			// only messages addressed to us get acked, and only if they asked for it
+			uint16_t ack_id = 0;
+			if (type == APRS_TYPE_MESSAGE && heard >= APRS_DUPE_WINDOW_10MS && APRS_destined_to_user(&frame))
+				ack_id = APRS_get_msg_id(&frame);
+			if(ack_id)
 		#else
 			if (dataPacket.data.header == MESSAGE_PACKET ||
 				dataPacket.data.header == ENCRYPTED_MESSAGE_PACKET)
 		#endif
 		{
-			// wait so the correspondent radio can properly receive it
-			SYSTEM_DelayMs(700);
-			
 			#ifdef ENABLE_APRS
-				MSG_SendAck(ack_id);
+				char origin_callsign[AX25_ADDRESS_STRING_SIZE + 1];
+				AX25_address_to_string(&frame, AX25_SOURCE, origin_callsign);
+				MSG_SendAck(ack_id, origin_callsign);
 			#else
 				MSG_SendAck();
 			#endif
@@ -382,8 +455,13 @@ void MSG_Send(char *cMessage){
 	}
 
 	#ifdef ENABLE_APRS
-		uint16_t len = APRS_prepare_message(&ax25frame, cMessage, false);
-		MSG_SendPacket(ax25frame.raw_buffer, len);
+		// sent from the outbox, which keeps retrying until it is acked
+		APRSOutbound * message = APRS_outbox_add(cMessage);
+		if (message == NULL) {
+			AUDIO_PlayBeep(BEEP_500HZ_60MS_DOUBLE_BEEP_OPTIONAL);
+			return;
+		}
+		MSG_SendOutbound(message);
 	#else
 		uint16_t len = NUNU_prepare_message(&dataPacket, cMessage);
 		MSG_SendPacket(
@@ -394,7 +472,11 @@ void MSG_Send(char *cMessage){
 
 	moveUP(rxMessage);
 
-	sprintf(rxMessage[3], "> %s", cMessage);
+	#ifdef ENABLE_APRS
+		snprintf(rxMessage[3], sizeof(rxMessage[3]), "%c%u> %s", delivery_marker[message->state], message->id, cMessage);
+	#else
+		sprintf(rxMessage[3], "> %s", cMessage);
+	#endif
 
 	memset(lastcMessage, 0, sizeof(lastcMessage));
 
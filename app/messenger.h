@@ -48,7 +48,8 @@ typedef union {
     uint8_t
       ack        :1, // determines whether the radio will automatically respond to messages with ACK
       encrypt    :1, // determines whether outgoing messages will be encrypted
-      unused     :6;
+      digi       :3, // most WIDEn-N hops the APRS digipeater takes on, 0 is off
+      unused     :3;
   } data;
   uint8_t __val;
 } MessengerConfig;
@@ -57,7 +58,9 @@ void MSG_Init();
 void MSG_ProcessKeys(KEY_Code_t Key, bool bKeyPressed, bool bKeyHeld);
 void MSG_SendPacket(char * packet, uint16_t len);
 #ifdef ENABLE_APRS
-  void MSG_SendAck(uint16_t ack_id);
+  void MSG_SendAck(uint16_t ack_id, const char * to_callsign);
+  // sends outbox messages as they come due
+  void MSG_TimeSlice500ms(void);
 #else
   void MSG_SendAck();
 #endif
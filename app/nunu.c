@@ -46,9 +46,7 @@ uint16_t NUNU_prepare_message(DataPacket *dataPacket, const char * message) {
                 dataPacket->data.payload,
                 PAYLOAD_LENGTH,
                 dataPacket->data.payload,
-                &(dataPacket->data.nonce),
-                gEncryptionKey,
-                256
+                &(dataPacket->data.nonce)
             );
             return 1 + PAYLOAD_LENGTH + NONCE_LENGTH;
         } else {
@@ -82,9 +80,7 @@ uint8_t NUNU_parse(DataPacket *dataPacket, char * origin, uint16_t len) {
             CRYPTO_Crypt(dataPacket->data.payload,
                 PAYLOAD_LENGTH,
                 dataPacket->data.payload,
-                &dataPacket->data.nonce,
-                gEncryptionKey,
-                256);
+                &dataPacket->data.nonce);
 
             memcpy(dataPacket->serializedArray, origin, 1 + PAYLOAD_LENGTH + NONCE_LENGTH);
         } else {
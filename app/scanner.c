@@ -17,6 +17,8 @@
  *     limitations under the License.
  */
 
+#include <string.h>
+
 #include "app/app.h"
 #include "app/dtmf.h"
 #include "app/generic.h"
@@ -24,6 +26,7 @@
 #include "app/scanner.h"
 #include "audio.h"
 #include "driver/bk4819.h"
+#include "driver/systick.h"
 #include "frequencies.h"
 #include "misc.h"
 #include "radio.h"
@@ -41,9 +44,89 @@ SCAN_CssState_t   gScanCssState;
 uint8_t           gScanProgressIndicator;
 bool              gScanUseCssResult;
 
+uint16_t          gScanCssLockTime_10ms;
+uint8_t           gScanCssFalseHits;
+
 STEP_Setting_t    stepSetting;
 uint8_t           scanHitCount;
 
+// Codes decoded from the CxCSS scan results so far. One is only taken once it
+// got CSS_VOTES_LOCK votes and leads every other candidate by CSS_VOTES_LEAD,
+// so a single misread on a noisy carrier doesn't end the scan with a wrong code.
+#define CSS_CANDIDATES 4
+#define CSS_VOTES_LOCK 3
+#define CSS_VOTES_LEAD 2
+
+typedef struct {
+	DCS_CodeType_t Type;
+	uint8_t        Code;
+	uint8_t        Votes;
+} CSS_Candidate_t;
+
+static CSS_Candidate_t cssCandidates[CSS_CANDIDATES];
+static uint8_t         cssUndecoded;  // results that matched no code at all
+static uint32_t        cssScanStart;  // gGlobalSysTickCounter when the code scan started
+
+static void SCANNER_ResetCss(void)
+{
+	memset(cssCandidates, 0, sizeof(cssCandidates));
+	cssUndecoded          = 0;
+	cssScanStart          = gGlobalSysTickCounter;
+	gScanCssLockTime_10ms = 0;
+	gScanCssFalseHits     = 0;
+}
+
+// counts a vote for Type/Code, returns true once it has the lock
+static bool SCANNER_VoteCss(DCS_CodeType_t Type, uint8_t Code)
+{
+	CSS_Candidate_t *pVote    = NULL;
+	CSS_Candidate_t *pWeakest = NULL;
+	uint8_t          RunnerUp = 0;
+	unsigned int     i;
+
+	for (i = 0; i < CSS_CANDIDATES; i++)
+	{
+		CSS_Candidate_t *pCandidate = &cssCandidates[i];
+
+		if (pCandidate->Votes > 0 && pCandidate->Type == Type && pCandidate->Code == Code)
+		{
+			pVote = pCandidate;
+			break;
+		}
+
+		if (pWeakest == NULL || pCandidate->Votes < pWeakest->Votes)
+			pWeakest = pCandidate;
+	}
+
+	if (pVote == NULL)
+	{	// new code, takes the place of the least voted one
+		pVote        = pWeakest;
+		pVote->Type  = Type;
+		pVote->Code  = Code;
+		pVote->Votes = 0;
+	}
+
+	if (pVote->Votes < 0xFF)
+		pVote->Votes++;
+
+	for (i = 0; i < CSS_CANDIDATES; i++)
+		if (&cssCandidates[i] != pVote && cssCandidates[i].Votes > RunnerUp)
+			RunnerUp = cssCandidates[i].Votes;
+
+	if (pVote->Votes < CSS_VOTES_LOCK || pVote->Votes < RunnerUp + CSS_VOTES_LEAD)
+		return false;
+
+	// everything that wasn't a vote for the winner was a false hit
+	gScanCssFalseHits = cssUndecoded;
+	for (i = 0; i < CSS_CANDIDATES; i++)
+		if (&cssCandidates[i] != pVote)
+			gScanCssFalseHits += cssCandidates[i].Votes;
+
+	gScanCssLockTime_10ms = MIN(gGlobalSysTickCounter - cssScanStart, 0xFFFFu);
+
+	return true;
+}
+
 
 static void SCANNER_Key_DIGITS(KEY_Code_t Key, bool bKeyPressed, bool bKeyHeld)
 {
@@ -337,6 +420,7 @@ void SCANNER_Start(bool singleFreq)
 
 		BK4819_PickRXFilterPathBasedOnFrequency(gScanFrequency);
 		BK4819_SetScanFrequency(gScanFrequency);
+		SCANNER_ResetCss();
 
 		gUpdateStatus = true;
 	}
@@ -433,6 +517,7 @@ void SCANNER_TimeSlice10ms(void)
 			}
 			else {
 				BK4819_SetScanFrequency(gScanFrequency);
+				SCANNER_ResetCss();
 				gScanCssResultCode     = 0xFF;
 				gScanCssResultType     = 0xFF;
 				scanHitCount          = 0;
@@ -459,36 +544,34 @@ void SCANNER_TimeSlice10ms(void)
 
 			BK4819_Disable();
 
+			DCS_CodeType_t Type = CODE_TYPE_OFF;
+			uint8_t        Code = 0xFF;
+
 			if (scanResult == BK4819_CSS_RESULT_CDCSS) {
-				const uint8_t Code = DCS_GetCdcssCode(cdcssFreq);
-				if (Code != 0xFF)
-				{
-					gScanCssResultCode = Code;
-					gScanCssResultType = CODE_TYPE_DIGITAL;
-					gScanCssState      = SCAN_CSS_STATE_FOUND;
-					gScanUseCssResult  = true;
-					gUpdateStatus      = true;
-				}
+				// inverted DCS is a code of its own, so polarity is part of the vote
+				Code = DCS_FindCdcssCode(cdcssFreq, &Type);
 			}
 			else if (scanResult == BK4819_CSS_RESULT_CTCSS) {
-				const uint8_t Code = DCS_GetCtcssCode(ctcssFreq);
-				if (Code != 0xFF) {
-					
-					++scanHitCount;
-					gScanCssState      = SCAN_CSS_STATE_FOUND;
-					gScanUseCssResult  = true;
-					gUpdateStatus      = true;
-					gScanCssResultType = CODE_TYPE_CONTINUOUS_TONE;
-					gScanCssResultCode = Code;
-				}
-				else {
-					scanHitCount = 0;
-				}
+				Type = CODE_TYPE_CONTINUOUS_TONE;
+				Code = DCS_GetCtcssCode(ctcssFreq);
+			}
+
+			if (Code == 0xFF) {
+				if (cssUndecoded < 0xFF)
+					cssUndecoded++;
+			}
+			else if (SCANNER_VoteCss(Type, Code)) {
+				gScanCssResultCode = Code;
+				gScanCssResultType = Type;
+				gScanCssState      = SCAN_CSS_STATE_FOUND;
+				gScanUseCssResult  = true;
+				gUpdateStatus      = true;
 			}
 
 			if (gScanCssState < SCAN_CSS_STATE_FOUND) { // scanning or off
+				// re-arm straight away and look again on the next tick, the chip
+				// needs a good deal longer than that for its next result
 				BK4819_SetScanFrequency(gScanFrequency);
-				gScanDelay_10ms = 1;
 				break;
 			}
 
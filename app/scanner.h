@@ -48,6 +48,8 @@ extern uint32_t          gScanFrequency;
 extern SCAN_CssState_t   gScanCssState;
 extern uint8_t           gScanProgressIndicator;
 extern bool              gScanUseCssResult;
+extern uint16_t          gScanCssLockTime_10ms; // from start of the code scan until it settled on a code
+extern uint8_t           gScanCssFalseHits;     // results during that time that weren't the code found
 
 void SCANNER_ProcessKeys(KEY_Code_t Key, bool bKeyPressed, bool bKeyHeld);
 void SCANNER_Start(bool singleFreq);
@@ -15,6 +15,10 @@
  */
 #include "app/spectrum.h"
 
+#ifdef ENABLE_ACTIVITY_LOG
+#include "app/activity.h"
+#endif
+
 #ifdef ENABLE_SCAN_RANGES
 #include "chFrScanner.h"
 #endif
@@ -88,11 +92,31 @@ ScanInfo scanInfo;
 KeyboardState kbd = {KEY_INVALID, KEY_INVALID, 0};
 
 #ifdef ENABLE_SCAN_RANGES
-#define BLACKLIST_SIZE 200
-static uint16_t blacklistFreqs[BLACKLIST_SIZE];
-static uint8_t blacklistFreqsIdx;
+// Blacklisted stretches are kept as frequency ranges, so they survive zooming
+// and moving the view. Whenever the sweep changes they are mapped onto a bitset
+// over its bins. Sweeps with more bins than bits share a bit between
+// 1 << blacklistShift neighbours. Channel mode blacklists channels directly.
+// Ranges that touch are merged, once all are taken further ones are refused.
+#define BLACKLIST_RANGES 32
+#define BLACKLIST_BITS   2048
+
+typedef struct BlacklistRange {
+  uint32_t lo, hi; // [lo, hi)
+} BlacklistRange;
+
+static BlacklistRange blacklistRanges[BLACKLIST_RANGES];
+static uint8_t blacklistRangesCount;
+static bool isBlacklistFull;
+static uint32_t blacklistBits[BLACKLIST_BITS / 32];
+static uint8_t blacklistShift;
+// sweep the bitset was built for
+static uint32_t blacklistFStart;
+static uint16_t blacklistStep, blacklistCount;
+// rssiHistory column per bin in Q16, for sweeps wider than the screen
+static uint32_t columnStep;
 static bool IsBlacklisted(uint16_t idx);
 static uint8_t CurrentScanIndex();
+static void RemapBlacklist();
 #endif
 
 const char *bwOptions[] = {"  25k", "12.5k", "6.25k"};
@@ -135,7 +159,62 @@ RegisterSpec registerSpecs[] = {
 
 uint16_t statuslineUpdateTimer = 0;
 
+// Two stage sweep: a coarse pass with the widest filter finds out where
+// something is going on, only those stretches get swept again at the fine
+// step. Quiet ones keep the noise floor, so an empty band costs a fraction
+// of the fine steps.
+#define SWEEP_COARSE_STEP     S_STEP_25_0kHz  // the widest filter in scanStepBWRegValues
+#define SWEEP_COARSE_SPAN     scanStepValues[SWEEP_COARSE_STEP]
+#define SWEEP_COARSE_MAX      3     // at most 1 << 3 fine bins per coarse bin
+#define SWEEP_COARSE_MARGIN   6     // 3dB over the quietest coarse bin
+#define SWEEP_BW_WIDE         scanStepBWRegValues[SWEEP_COARSE_STEP]
+
+// adaptive dwell, a bin whose noise indicator says "carrier" gets one more
+// look once the RSSI filter caught up, an empty bin is done after the glitch wait
+#define DWELL_BUSY_NOISE      64
+#define DWELL_BUSY_US         400
+
+typedef enum SweepStage {
+  SWEEP_COARSE,
+  SWEEP_FINE,
+} SweepStage;
+
+static SweepStage sweepStage;
+static uint8_t coarseShift;     // fine bins per coarse bin, log2, 0 = no coarse pass
+static uint8_t coarseIndex;
+static uint8_t coarseLoudest;   // always swept fine, so peak and floor stay fine readings
+static uint16_t coarseMin;
+static uint16_t coarseRssi[128 / 2];
+
+static uint32_t sweepStartMs;
+static uint32_t sweepMs;        // duration of the last complete sweep
+
+#ifdef ENABLE_SPECTRUM_WATERFALL
+// Waterfall below a shortened spectrum. Every sweep is kept at 2 bits per
+// bin, 0 being dbMin and 3 dbMax, in a ring of the last WATERFALL_ROWS
+// sweeps (512 bytes). Its framebuffer pages survive Render(), a new sweep
+// shifts them down a row and only the new row is drawn.
+#define WATERFALL_ROWS    16
+#define WATERFALL_TOP     (DrawingEndY - WATERFALL_ROWS)
+#define WATERFALL_PAGE    (WATERFALL_TOP / 8)
+#define SpectrumEndY      (WATERFALL_TOP - 1)
+
+static uint8_t waterfall[WATERFALL_ROWS][128 / 4];
+static uint8_t waterfallHead;     // ring row of the newest sweep
+static uint8_t waterfallPending;  // sweeps not on the framebuffer yet
+static bool waterfallRepaint;     // pages were cleared, rebuild them from the ring
+
+// traces over the live spectrum
+static uint8_t peakHold[128];     // rssi / 2
+static uint16_t average[128];     // rssi << 4, moves 1/8 towards each sweep
+#else
+#define SpectrumEndY      DrawingEndY
+#endif
+
 static void RelaunchScan();
+#ifdef ENABLE_SPECTRUM_WATERFALL
+static void ResetWaterfall();
+#endif
 static void CheckIfTailFound();
 static void ResetInterrupts();
 
@@ -345,27 +424,41 @@ uint8_t GetScanStepFromStepFrequency(uint16_t stepFrequency)
 #endif
 
 static void DeInitSpectrum() {
+#ifdef ENABLE_ACTIVITY_LOG
+  ACTIVITY_End();
+  ACTIVITY_Flush();
+#endif
   SetF(initialFreq);
   RestoreRegisters();
   gVfoConfigureMode = VFO_CONFIGURE;
   isInitialized = false;
 }
 
-uint8_t GetBWRegValueForScan() {
+uint16_t GetBWRegValueForScan() {
   return scanStepBWRegValues[settings.scanStepIndex];
 }
   
-uint16_t GetRssi() {
+static uint16_t GetRawRssi() {
   uint16_t rssi;
-    // SYSTICK_DelayUs(800);
-  // testing autodelay based on Glitch value
 
-  // testing resolution to sticky squelch issue
+  // the glitch counter sits at 255 until PLL and filters settled
   while ((BK4819_ReadRegister(0x63) & 0b11111111) >= 255) {
     SYSTICK_DelayUs(100);
   }
   rssi = BK4819_GetRSSI();
- 
+
+  // RSSI of a carrier keeps rising for a bit after the tune
+  if (BK4819_GetExNoiceIndicator() < DWELL_BUSY_NOISE) {
+    SYSTICK_DelayUs(DWELL_BUSY_US);
+    rssi = MAX(rssi, BK4819_GetRSSI());
+  }
+
+  return rssi;
+}
+
+uint16_t GetRssi() {
+  uint16_t rssi = GetRawRssi();
+
   #ifdef ENABLE_SPECTRUM_CHANNEL_SCAN
     if ((appMode==CHANNEL_MODE) && (FREQUENCY_GetBand(fMeasure) > BAND4_174MHz))
     {
@@ -416,6 +509,9 @@ static void ToggleRX(bool on) {
   {
     if(appMode!=CHANNEL_MODE)
       BK4819_WriteRegister(0x43, GetBWRegValueForScan());
+  #ifdef ENABLE_ACTIVITY_LOG
+    ACTIVITY_End();
+  #endif
   }
 }
 
@@ -438,6 +534,23 @@ static void InitScan() {
   // prevents phantom channel bar
   if(appMode==CHANNEL_MODE)
     scanInfo.measurementsCount++;
+
+  sweepStartMs = SYSTICK_GetMs();
+
+  coarseShift = 0;
+  if (appMode == FREQUENCY_MODE && scanInfo.measurementsCount <= 128) {
+    while (coarseShift < SWEEP_COARSE_MAX &&
+           (scanInfo.scanStep << (coarseShift + 1)) <= SWEEP_COARSE_SPAN)
+      coarseShift++;
+  }
+  coarseIndex = 0;
+  sweepStage = coarseShift ? SWEEP_COARSE : SWEEP_FINE;
+
+#ifdef ENABLE_SCAN_RANGES
+  if (scanInfo.measurementsCount > 128)
+    columnStep = ((uint32_t)ARRAY_SIZE(rssiHistory) << 16) / scanInfo.measurementsCount;
+  RemapBlacklist();
+#endif
 }
 
 // resets modifiers like blacklist, attenuation, normalization
@@ -447,8 +560,11 @@ static void ResetModifiers() {
       rssiHistory[i] = 0;
   }
 #ifdef ENABLE_SCAN_RANGES
-  memset(blacklistFreqs, 0, sizeof(blacklistFreqs));
-  blacklistFreqsIdx = 0;
+  // bins and the blanked columns have to be laid out again, the ranges stay
+  blacklistCount = 0;
+  isBlacklistApplied = blacklistRangesCount > 0;
+#else
+  isBlacklistApplied = false;
 #endif
   if(appMode==CHANNEL_MODE){
       LoadValidMemoryChannels();
@@ -456,8 +572,10 @@ static void ResetModifiers() {
   }
   ToggleNormalizeRssi(false);
   memset(attenuationOffset, 0, sizeof(attenuationOffset));
+#ifdef ENABLE_SPECTRUM_WATERFALL
+  ResetWaterfall();
+#endif
   isAttenuationApplied = false;
-  isBlacklistApplied = false;
   RelaunchScan();
 }
 
@@ -703,12 +821,124 @@ static void UpdateFreqInput(KEY_Code_t key) {
   redrawScreen = true;
 }
 
-static void Blacklist() {
 #ifdef ENABLE_SCAN_RANGES
-  blacklistFreqs[blacklistFreqsIdx++ % ARRAY_SIZE(blacklistFreqs)] = peak.i;
-  rssiHistory[CurrentScanIndex()] = RSSI_MAX_VALUE;
+static uint8_t ScanIndexToColumn(uint16_t i)
+{
+  if(scanInfo.measurementsCount > 128)
+    return (i * columnStep) >> 16;
+  return i;
+}
+
+static void MarkBlacklisted(uint16_t idx)
+{
+  idx >>= blacklistShift;
+  blacklistBits[idx / 32] |= 1u << (idx % 32);
+}
+
+static void MarkBlacklistRange(const BlacklistRange *range)
+{
+  uint32_t lo = 0;
+  uint32_t hi;
+
+  if(range->hi <= blacklistFStart)
+    return;
+  if(range->lo > blacklistFStart)
+    lo = (range->lo - blacklistFStart) / blacklistStep;
+  // every bin the range touches, including the one past the last step
+  hi = (range->hi - blacklistFStart + blacklistStep - 1) / blacklistStep;
+  if(hi > blacklistCount + 1u)
+    hi = blacklistCount + 1u;
+
+  for(uint32_t i = lo; i < hi; i++)
+    MarkBlacklisted(i);
+}
+
+static bool AddBlacklistRange(uint32_t lo, uint32_t hi)
+{
+  uint8_t count = 0;
+
+  // fold every range it overlaps or touches into it. The ranges never touch
+  // each other, so one that only touches the grown range touched it before
+  for(uint8_t i = 0; i < blacklistRangesCount; i++) {
+    const BlacklistRange range = blacklistRanges[i];
+
+    if(lo <= range.hi && hi >= range.lo) {
+      lo = MIN(lo, range.lo);
+      hi = MAX(hi, range.hi);
+    } else {
+      blacklistRanges[count++] = range;
+    }
+  }
+
+  // nothing merged and no room left
+  if(count == BLACKLIST_RANGES)
+    return false;
+
+  blacklistRanges[count].lo = lo;
+  blacklistRanges[count].hi = hi;
+  blacklistRangesCount = count + 1;
+  MarkBlacklistRange(&blacklistRanges[count]);
+  return true;
+}
+
+static void RemapBlacklist()
+{
+  const uint32_t fStart = GetFStart();
+
+  if(fStart == blacklistFStart && scanInfo.scanStep == blacklistStep &&
+     scanInfo.measurementsCount == blacklistCount)
+    return;
+
+  blacklistFStart = fStart;
+  blacklistStep = scanInfo.scanStep;
+  blacklistCount = scanInfo.measurementsCount;
+
+  memset(blacklistBits, 0, sizeof(blacklistBits));
+  blacklistShift = 0;
+  while((blacklistCount >> blacklistShift) >= BLACKLIST_BITS)
+    blacklistShift++;
+
+  // channel numbers mean nothing once the list changed
+  if(appMode == CHANNEL_MODE) {
+    isBlacklistApplied = false;
+    return;
+  }
+
+  for(uint8_t i = 0; i < blacklistRangesCount; i++)
+    MarkBlacklistRange(&blacklistRanges[i]);
+
+  if(blacklistCount <= 128) {
+    for(uint8_t i = 0; i < 128; i++) {
+      if(IsBlacklisted(i))
+        rssiHistory[i] = RSSI_MAX_VALUE;
+      else if(rssiHistory[i] == RSSI_MAX_VALUE)
+        rssiHistory[i] = 0;
+    }
+  }
+}
+
+static void ResetBlacklist()
+{
+  blacklistRangesCount = 0;
+  blacklistCount = 0;
+  isBlacklistApplied = false;
+  isBlacklistFull = false;
+}
 #endif
+
+static void Blacklist() {
+#ifdef ENABLE_SCAN_RANGES
+  if(appMode == CHANNEL_MODE)
+    MarkBlacklisted(peak.i);
+  else if(!AddBlacklistRange(peak.f, peak.f + scanInfo.scanStep)) {
+    isBlacklistFull = true;
+    redrawScreen = true;
+    return;
+  }
+  rssiHistory[ScanIndexToColumn(peak.i)] = RSSI_MAX_VALUE;
+#else
   rssiHistory[peak.i] = RSSI_MAX_VALUE;
+#endif
   isBlacklistApplied = true;
   ResetPeak();
   ToggleRX(false);
@@ -718,23 +948,13 @@ static void Blacklist() {
 #ifdef ENABLE_SCAN_RANGES
 static uint8_t CurrentScanIndex()
 {
-  if(scanInfo.measurementsCount > 128) {
-    uint8_t i = (uint32_t)ARRAY_SIZE(rssiHistory) * 1000 / scanInfo.measurementsCount * scanInfo.i / 1000;
-    return i;
-  }
-  else
-  {
-    return scanInfo.i;
-  }
-  
+  return ScanIndexToColumn(scanInfo.i);
 }
 
 static bool IsBlacklisted(uint16_t idx)
 {
-  for(uint8_t i = 0; i < ARRAY_SIZE(blacklistFreqs); i++)
-    if(blacklistFreqs[i] == idx)
-      return true;
-  return false;
+  idx >>= blacklistShift;
+  return (blacklistBits[idx / 32] >> (idx % 32)) & 1u;
 }
 #endif
 
@@ -754,18 +974,127 @@ uint8_t Rssi2PX(uint16_t rssi, uint8_t pxMin, uint8_t pxMax) {
 }
 
 uint8_t Rssi2Y(uint16_t rssi) {
-  return DrawingEndY - Rssi2PX(rssi, 0, DrawingEndY);
+  return SpectrumEndY - Rssi2PX(rssi, 0, SpectrumEndY);
 }
 
 static void DrawSpectrum() {
   for (uint8_t x = 0; x < 128; ++x) {
     uint16_t rssi = rssiHistory[x >> settings.stepsCount];
     if (rssi != RSSI_MAX_VALUE) {
-      DrawVLine(Rssi2Y(rssi), DrawingEndY, x, true);
+      DrawVLine(Rssi2Y(rssi), SpectrumEndY, x, true);
     }
   }
 }
 
+#ifdef ENABLE_SPECTRUM_WATERFALL
+static void ResetWaterfall() {
+  memset(waterfall, 0, sizeof(waterfall));
+  memset(peakHold, 0, sizeof(peakHold));
+  memset(average, 0, sizeof(average));
+  waterfallRepaint = true;
+}
+
+static void WaterfallAddSweep() {
+  uint8_t *row;
+
+  waterfallHead = (waterfallHead + 1) % WATERFALL_ROWS;
+  row = waterfall[waterfallHead];
+  memset(row, 0, sizeof(waterfall[0]));
+
+  for (uint8_t i = 0; i < 128; ++i) {
+    const uint16_t rssi = rssiHistory[i];
+    if (rssi == RSSI_MAX_VALUE || rssi == 0) {
+      continue;
+    }
+
+    row[i >> 2] |= Rssi2PX(rssi, 0, 3) << ((i & 3) << 1);
+
+    if (rssi >> 1 > peakHold[i]) {
+      peakHold[i] = rssi >> 1;
+    }
+    if (average[i] == 0) {
+      average[i] = rssi << 4;
+    } else {
+      average[i] += ((int)(rssi << 4) - average[i]) / 8;
+    }
+  }
+
+  if (waterfallPending < WATERFALL_ROWS) {
+    waterfallPending++;
+  }
+}
+
+// ordered dither, the pattern follows the ring row so it doesn't flicker
+// while scrolling
+static bool WaterfallDot(uint8_t level, uint8_t x, uint8_t ringRow) {
+  switch (level) {
+  case 1:
+    return !(x & 1) && !(ringRow & 1);
+  case 2:
+    return !((x ^ ringRow) & 1);
+  case 3:
+    return true;
+  default:
+    return false;
+  }
+}
+
+static void WaterfallDrawRow(uint8_t ringRow) {
+  const uint8_t *row = waterfall[ringRow];
+  for (uint8_t x = 0; x < 128; ++x) {
+    const uint8_t bin = x >> settings.stepsCount;
+    const uint8_t level = (row[bin >> 2] >> ((bin & 3) << 1)) & 3;
+    if (WaterfallDot(level, x, ringRow)) {
+      gFrameBuffer[WATERFALL_PAGE][x] |= 1;
+    }
+  }
+}
+
+static void WaterfallScroll() {
+  for (uint8_t x = 0; x < 128; ++x) {
+    uint16_t column = gFrameBuffer[WATERFALL_PAGE][x] |
+                      gFrameBuffer[WATERFALL_PAGE + 1][x] << 8;
+    column <<= 1;
+    gFrameBuffer[WATERFALL_PAGE][x] = column;
+    gFrameBuffer[WATERFALL_PAGE + 1][x] = column >> 8;
+  }
+}
+
+static void DrawWaterfall() {
+  if (waterfallRepaint) {
+    memset(gFrameBuffer[WATERFALL_PAGE], 0, 2 * sizeof(gFrameBuffer[0]));
+    waterfallPending = WATERFALL_ROWS;
+    waterfallRepaint = false;
+  }
+
+  // oldest first, the newest one ends up on top
+  for (; waterfallPending; --waterfallPending) {
+    WaterfallScroll();
+    WaterfallDrawRow((waterfallHead + 1 + WATERFALL_ROWS - waterfallPending) %
+                     WATERFALL_ROWS);
+  }
+}
+
+static void DrawTraces() {
+  for (uint8_t x = 0; x < 128; ++x) {
+    const uint8_t bin = x >> settings.stepsCount;
+    uint8_t y;
+
+    if (rssiHistory[bin] == RSSI_MAX_VALUE || !peakHold[bin]) {
+      continue;
+    }
+
+    PutPixel(x, Rssi2Y(peakHold[bin] << 1), true);
+
+    // dotted, and inverted where it runs inside a bar
+    if (!(x & 1)) {
+      y = Rssi2Y(average[bin] >> 4);
+      gFrameBuffer[y >> 3][x] ^= 1 << (y & 7);
+    }
+  }
+}
+#endif
+
 static void DrawStatus() {
 #ifdef SPECTRUM_EXTRA_VALUES
   sprintf(String, "%d/%d P:%d T:%d", settings.dbMin, settings.dbMax,
@@ -785,6 +1114,18 @@ static void DrawStatus() {
 #endif
   GUI_DisplaySmallest(String, 0, 1, true, true);
 
+  // sweeps per second, and the revisit time of a bin, which is how long a
+  // burst may have to wait until it is seen
+  if (sweepMs && currentState == SPECTRUM
+#ifdef ENABLE_SPECTRUM_SHOW_CHANNEL_NAME
+      && !isKnownChannel
+#endif
+  ) {
+    sprintf(String, "%u.%u/s %ums", (unsigned)(1000 / sweepMs),
+            (unsigned)(10000 / sweepMs % 10), (unsigned)sweepMs);
+    GUI_DisplaySmallest(String, 44, 1, true, true);
+  }
+
   BOARD_ADC_GetBatteryInfo(&gBatteryVoltages[gBatteryCheckCounter++ % 4]);
 
   uint16_t voltage = (gBatteryVoltages[0] + gBatteryVoltages[1] + gBatteryVoltages[2] +
@@ -883,6 +1224,13 @@ static void DrawNums() {
     GUI_DisplaySmallest(String, 52, 49, false, true);
   }
 
+#ifdef ENABLE_SCAN_RANGES
+  if(isBlacklistFull){
+    sprintf(String, "FULL"); // where BL goes, more would run into the end frequency
+    GUI_DisplaySmallest(String, 67, 49, false, true);
+  }
+  else
+#endif
   if(isBlacklistApplied){
     sprintf(String, "BL");
     GUI_DisplaySmallest(String, 67, 49, false, true);
@@ -962,6 +1310,7 @@ static void OnKeyDown(uint8_t key) {
     }
     else
     {
+      ResetBlacklist();
       ResetModifiers();
     }
     break;
@@ -974,6 +1323,7 @@ static void OnKeyDown(uint8_t key) {
     }
     else
     {
+      ResetBlacklist();
       ResetModifiers();
     }
     break;
@@ -1066,6 +1416,11 @@ static void OnKeyDownFreqInput(uint8_t key) {
     SetState(previousState);
     currentFreq = tempFreq;
     if (currentState == SPECTRUM) {
+#ifdef ENABLE_SCAN_RANGES
+      // UP and DOWN move the view in frequency mode, a typed frequency
+      // is somewhere else and starts with a clean blacklist
+      ResetBlacklist();
+#endif
       ResetModifiers();
     } else {
       SetF(currentFreq);
@@ -1167,6 +1522,10 @@ static void RenderSpectrum() {
     DrawArrow(128u * peak.i / GetStepsCount());
   }
   DrawSpectrum();
+#ifdef ENABLE_SPECTRUM_WATERFALL
+  DrawTraces();
+  DrawWaterfall();
+#endif
   DrawRssiTriggerLevel();
   DrawF(peak.f);
   DrawNums();
@@ -1242,7 +1601,19 @@ static void RenderStill() {
 }
 
 static void Render() {
+#ifdef ENABLE_SPECTRUM_WATERFALL
+  if (currentState == SPECTRUM) {
+    // keep the waterfall pages, DrawWaterfall only scrolls them
+    memset(gFrameBuffer, 0, WATERFALL_PAGE * sizeof(gFrameBuffer[0]));
+    memset(gFrameBuffer[WATERFALL_PAGE + 2], 0,
+           sizeof(gFrameBuffer) - (WATERFALL_PAGE + 2) * sizeof(gFrameBuffer[0]));
+  } else {
+    memset(gFrameBuffer, 0, sizeof(gFrameBuffer));
+    waterfallRepaint = true;
+  }
+#else
   memset(gFrameBuffer, 0, sizeof(gFrameBuffer));
+#endif
 
   switch (currentState) {
   case SPECTRUM:
@@ -1291,12 +1662,56 @@ bool HandleUserInput() {
   return true;
 }
 
+static bool IsBinQuiet(uint16_t i) {
+  const uint16_t group = i >> coarseShift;
+  return coarseShift && group < (scanInfo.measurementsCount >> coarseShift) &&
+         group != coarseLoudest &&
+         coarseRssi[group] < coarseMin + SWEEP_COARSE_MARGIN;
+}
+
+static void ScanCoarse() {
+  const uint8_t groups = scanInfo.measurementsCount >> coarseShift;
+  uint16_t rssi;
+
+  if (coarseIndex == 0) {
+    BK4819_WriteRegister(BK4819_REG_43, SWEEP_BW_WIDE);
+    coarseMin = RSSI_MAX_VALUE;
+    coarseLoudest = 0;
+  }
+
+  // middle of the stretch the coarse bin stands for
+  SetF(GetFStart() +
+       (uint32_t)((coarseIndex << coarseShift) + (1 << (coarseShift - 1))) *
+           scanInfo.scanStep);
+  rssi = coarseRssi[coarseIndex] = GetRawRssi();
+  if (rssi < coarseMin)
+    coarseMin = rssi;
+  if (rssi > coarseRssi[coarseLoudest])
+    coarseLoudest = coarseIndex;
+
+  if (++coarseIndex < groups)
+    return;
+
+  BK4819_WriteRegister(BK4819_REG_43, GetBWRegValueForScan());
+
+  // the wide filter sees more noise than the fine one, quiet bins show the
+  // fine noise floor once there is one
+  for (uint16_t i = 0; i < scanInfo.measurementsCount; ++i) {
+    if (rssiHistory[i] != RSSI_MAX_VALUE && IsBinQuiet(i)) {
+      rssi = coarseRssi[i >> coarseShift];
+      rssiHistory[i] = MIN(rssi, scanInfo.rssiMin);
+    }
+  }
+
+  sweepStage = SWEEP_FINE;
+}
+
 static void Scan() {
-  if (rssiHistory[scanInfo.i] != RSSI_MAX_VALUE
 #ifdef ENABLE_SCAN_RANGES
-  && !IsBlacklisted(scanInfo.i)
+  if (!IsBlacklisted(scanInfo.i) && !IsBinQuiet(scanInfo.i)) {
+#else
+  if (rssiHistory[scanInfo.i] != RSSI_MAX_VALUE && !IsBinQuiet(scanInfo.i)) {
 #endif
-  ) {
     SetF(scanInfo.f);
     Measure();
     UpdateScanInfo();
@@ -1328,6 +1743,11 @@ static void NextScanStep() {
 }
 
 static void UpdateScan() {
+  if (sweepStage == SWEEP_COARSE) {
+    ScanCoarse();
+    return;
+  }
+
   Scan();
 
   if (scanInfo.i < GetStepsCount()) {
@@ -1335,6 +1755,12 @@ static void UpdateScan() {
     return;
   }
 
+  sweepMs = SYSTICK_GetMs() - sweepStartMs;
+  redrawStatus = true;
+#ifdef ENABLE_SPECTRUM_WATERFALL
+  WaterfallAddSweep();
+#endif
+
   if(scanInfo.measurementsCount < 128)
     memset(&rssiHistory[scanInfo.measurementsCount], 0, 
       sizeof(rssiHistory) - scanInfo.measurementsCount*sizeof(rssiHistory[0]));
@@ -1346,6 +1772,9 @@ static void UpdateScan() {
   if (IsPeakOverLevel()) {
     ToggleRX(true);
     TuneToPeak();
+  #ifdef ENABLE_ACTIVITY_LOG
+    ACTIVITY_Start(ACTIVITY_SOURCE_SPECTRUM, peak.f, peak.rssi);
+  #endif
     return;
   }
 
@@ -1385,6 +1814,9 @@ static void UpdateListening() {
 
   peak.rssi = scanInfo.rssi;
   redrawScreen = true;
+#ifdef ENABLE_ACTIVITY_LOG
+  ACTIVITY_Update(scanInfo.rssi);
+#endif
 
   CheckIfTailFound();
 
@@ -1411,6 +1843,9 @@ static void Tick() {
       if (IsPeakOverLevel()) {
         ToggleRX(true);
         TuneToPeak();
+      #ifdef ENABLE_ACTIVITY_LOG
+        ACTIVITY_Start(ACTIVITY_SOURCE_SPECTRUM, peak.f, peak.rssi);
+      #endif
         return;
       }
       redrawScreen = true;
@@ -1450,6 +1885,9 @@ static void Tick() {
 void APP_RunSpectrum(Mode mode) {
   // reset modifiers if we launched in a different then previous mode
   if(appMode!=mode){
+  #ifdef ENABLE_SCAN_RANGES
+    ResetBlacklist();
+  #endif
     ResetModifiers();
   }
   appMode = mode;
@@ -1509,11 +1947,15 @@ void APP_RunSpectrum() {
   for (int i = 0; i < 128; ++i) {
     rssiHistory[i] = 0;
   }
+#ifdef ENABLE_SPECTRUM_WATERFALL
+  ResetWaterfall();
+#endif
 
   isInitialized = true;
 
   while (isInitialized) {
     Tick();
+    ST7565_Pump();
   }
 }
 
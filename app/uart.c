@@ -22,11 +22,23 @@
 #if !defined(ENABLE_OVERLAY)
 	#include "ARMCM0.h"
 #endif
+#ifdef ENABLE_ACTIVITY_LOG
+	#include "app/activity.h"
+#endif
+#ifdef ENABLE_APRS_DIGI
+	#include "app/digi.h"
+#endif
 #ifdef ENABLE_FMRADIO
 	#include "app/fm.h"
 #endif
+#ifdef ENABLE_KISS
+	#include "app/kiss.h"
+#endif
 #include "app/uart.h"
 #include "board.h"
+#ifdef ENABLE_CHANNEL_CACHE
+	#include "channels.h"
+#endif
 #include "bsp/dp32g030/dma.h"
 #include "bsp/dp32g030/gpio.h"
 #include "driver/backlight.h"
@@ -35,6 +47,7 @@
 #include "driver/eeprom.h"
 #include "driver/gpio.h"
 #include "driver/uart.h"
+#include "external/printf/printf.h"
 #include "functions.h"
 #include "misc.h"
 #include "settings.h"
@@ -284,6 +297,10 @@ static void CMD_051D(const uint8_t *pBuffer)
 	if (!bIsLocked)
 	{
 		unsigned int i;
+		#ifdef ENABLE_ACTIVITY_LOG
+			bool bReloadActivity = false;
+		#endif
+
 		for (i = 0; i < (pCmd->Size / 8); i++)
 		{
 			const uint16_t Offset = pCmd->Offset + (i * 8U);
@@ -292,10 +309,28 @@ static void CMD_051D(const uint8_t *pBuffer)
 				if (!gIsLocked)
 					bReloadEeprom = true;
 
+			#ifdef ENABLE_ACTIVITY_LOG
+				// the log lives in the contacts area, an image written over it has to be checked again
+				if (Offset >= 0x1C00 && Offset < 0x1E00)
+					bReloadActivity = true;
+			#endif
+
 			if ((Offset < 0x0E98 || Offset >= 0x0EA0) || !bIsInLockScreen || pCmd->bAllowPassword)
 				EEPROM_WriteBuffer(Offset, &pCmd->Data[i * 8U], true);
 		}
 
+		EEPROM_Flush();
+
+		#ifdef ENABLE_CHANNEL_CACHE
+			// the channels may have been rewritten
+			CHANNELS_Invalidate();
+		#endif
+
+		#ifdef ENABLE_ACTIVITY_LOG
+			if (bReloadActivity)
+				ACTIVITY_Init();
+		#endif
+
 		if (bReloadEeprom)
 			BOARD_EEPROM_Init();
 	}
@@ -363,6 +398,47 @@ static void CMD_052F(const uint8_t *pBuffer)
 	SendVersion();
 }
 
+static void SendBK4819Counters(void)
+{
+	char Line[96];
+	int  Length;
+
+	// bus writes of the last init, AGC setup, RADIO_SetupRegisters and FSK_configure
+	Length = snprintf(Line, sizeof(Line), "BK4819 wr %u init %u agc %u setup %u fsk %u",
+		(unsigned int)gBK4819_BusWrites,
+		gBK4819_OperationWrites[BK4819_OP_INIT],
+		gBK4819_OperationWrites[BK4819_OP_AGC],
+		gBK4819_OperationWrites[BK4819_OP_SETUP],
+		gBK4819_OperationWrites[BK4819_OP_FSK]);
+#ifdef ENABLE_BK4819_SHADOW
+	Length += snprintf(Line + Length, sizeof(Line) - Length, " rd-saved %u wr-saved %u",
+		(unsigned int)gBK4819_ReadsSaved,
+		(unsigned int)gBK4819_WritesSaved);
+#endif
+	Length += snprintf(Line + Length, sizeof(Line) - Length, "\r\n");
+
+	UART_Send(Line, Length);
+}
+
+#ifdef ENABLE_KISS
+// matches a text command against the bytes that have arrived so far
+// @returns 1 on a match, 0 on a mismatch, -1 if it may still match once more arrives
+static int UART_MatchText(const char *pText, uint16_t Available)
+{
+	uint16_t i;
+
+	for (i = 0; pText[i] != 0; i++)
+	{
+		if (i == Available)
+			return -1;
+		if (UART_DMA_Buffer[DMA_INDEX(gUART_WriteIndex, i)] != (uint8_t)pText[i])
+			return 0;
+	}
+
+	return 1;
+}
+#endif
+
 bool UART_IsCommandAvailable(void)
 {
 	uint16_t Index;
@@ -372,6 +448,18 @@ bool UART_IsCommandAvailable(void)
 	uint16_t CommandLength;
 	uint16_t DmaLength = DMA_CH0->ST & 0xFFFU;
 
+#ifdef ENABLE_KISS
+	if (KISS_IsActive())
+	{	// nothing but KISS frames until the host leaves KISS mode
+		while (gUART_WriteIndex != DmaLength)
+		{
+			KISS_Feed(UART_DMA_Buffer[gUART_WriteIndex]);
+			gUART_WriteIndex = DMA_INDEX(gUART_WriteIndex, 1);
+		}
+		return false;
+	}
+#endif
+
 	while (1)
 	{
 		if (gUART_WriteIndex == DmaLength)
@@ -398,6 +486,37 @@ bool UART_IsCommandAvailable(void)
       }
     }
 
+#endif
+#ifdef ENABLE_ACTIVITY_LOG
+		if (strncmp(((char*)UART_DMA_Buffer) + gUART_WriteIndex, "LOG?", 4) == 0)
+			ACTIVITY_Dump();
+#endif
+		if (strncmp(((char*)UART_DMA_Buffer) + gUART_WriteIndex, "BK4819?", 7) == 0)
+			SendBK4819Counters();
+#ifdef ENABLE_APRS_DIGI
+		if (strncmp(((char*)UART_DMA_Buffer) + gUART_WriteIndex, "DIGI?", 5) == 0)
+			DIGI_report();
+#endif
+#ifdef ENABLE_KISS
+		{	// "KISS" is a prefix of "KISS?", so it needs its line end before
+			// it counts and nothing is decided until enough has arrived
+			const uint16_t Available = (DmaLength + sizeof(UART_DMA_Buffer) - gUART_WriteIndex) % sizeof(UART_DMA_Buffer);
+			const int      Report    = UART_MatchText("KISS?", Available);
+			const int      Start     = MAX(UART_MatchText("KISS\r", Available), UART_MatchText("KISS\n", Available));
+
+			if (Report < 0 || Start < 0)
+				return false;
+
+			if (Report > 0)
+				KISS_Report();
+			else
+			if (Start > 0)
+			{
+				KISS_Start();
+				gUART_WriteIndex = DMA_INDEX(gUART_WriteIndex, 5);
+				return false;
+			}
+		}
 #endif
 		while (gUART_WriteIndex != DmaLength && UART_DMA_Buffer[gUART_WriteIndex] != 0xABU)
 			gUART_WriteIndex = DMA_INDEX(gUART_WriteIndex, 1);
@@ -513,6 +632,7 @@ void UART_HandleCommand(void)
 			break;
 
 		case 0x05DD:
+			EEPROM_Flush();
 			#if defined(ENABLE_OVERLAY)
 				overlay_FLASH_RebootToBootloader();
 			#else
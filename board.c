@@ -19,11 +19,17 @@
 
 #include <string.h>
 
+#ifdef ENABLE_ACTIVITY_LOG
+	#include "app/activity.h"
+#endif
 #include "app/dtmf.h"
 #ifdef ENABLE_FMRADIO
 	#include "app/fm.h"
 #endif
 #include "board.h"
+#ifdef ENABLE_CHANNEL_CACHE
+	#include "channels.h"
+#endif
 #include "bsp/dp32g030/gpio.h"
 #include "bsp/dp32g030/portcon.h"
 #include "bsp/dp32g030/saradc.h"
@@ -511,15 +517,24 @@ void BOARD_Init(void)
 	CRC_Init();
 }
 
+// settings live in 0E70..0F47, read them in one go rather than a bus transaction per record
+#define SETTINGS_IMAGE_START 0x0E70
+#define SETTINGS_IMAGE_END   0x0F48
+
 void BOARD_EEPROM_Init(void)
 {
 	unsigned int i;
-	uint8_t      Data[16];
+	uint8_t      Image[SETTINGS_IMAGE_END - SETTINGS_IMAGE_START];
+	uint8_t     *Data;
 
-	memset(Data, 0, sizeof(Data));
+	#define SETTINGS_IMAGE(Address) (Image + ((Address) - SETTINGS_IMAGE_START))
+
+	// 0D60..0E2E
+	EEPROM_ReadBuffer(0x0D60, gMR_ChannelAttributes, sizeof(gMR_ChannelAttributes));
+	EEPROM_ReadBuffer(SETTINGS_IMAGE_START, Image, sizeof(Image));
 
 	// 0E70..0E77
-	EEPROM_ReadBuffer(0x0E70, Data, 8);
+	Data = SETTINGS_IMAGE(0x0E70);
 	gEeprom.CHAN_1_CALL          = IS_MR_CHANNEL(Data[0]) ? Data[0] : MR_CHANNEL_FIRST;
 	gEeprom.SQUELCH_LEVEL        = (Data[1] < 10) ? Data[1] : 1;
 	gEeprom.TX_TIMEOUT_TIMER     = (Data[2] < 11) ? Data[2] : 1;
@@ -534,7 +549,7 @@ void BOARD_EEPROM_Init(void)
 	gEeprom.MIC_SENSITIVITY      = (Data[7] <  5) ? Data[7] : 4;
 
 	// 0E78..0E7F
-	EEPROM_ReadBuffer(0x0E78, Data, 8);
+	Data = SETTINGS_IMAGE(0x0E78);
 	gEeprom.BACKLIGHT_MAX 		  = (Data[0] & 0xF) <= 10 ? (Data[0] & 0xF) : 10;
 	gEeprom.BACKLIGHT_MIN 		  = (Data[0] >> 4) < gEeprom.BACKLIGHT_MAX ? (Data[0] >> 4) : 0;
 #ifdef ENABLE_BLMIN_TMP_OFF
@@ -548,7 +563,7 @@ void BOARD_EEPROM_Init(void)
 	gEeprom.VFO_OPEN              = (Data[7] < 2) ? Data[7] : true;
 
 	// 0E80..0E87
-	EEPROM_ReadBuffer(0x0E80, Data, 8);
+	Data = SETTINGS_IMAGE(0x0E80);
 	gEeprom.ScreenChannel[0]   = IS_VALID_CHANNEL(Data[0]) ? Data[0] : (FREQ_CHANNEL_FIRST + BAND6_400MHz);
 	gEeprom.ScreenChannel[1]   = IS_VALID_CHANNEL(Data[3]) ? Data[3] : (FREQ_CHANNEL_FIRST + BAND6_400MHz);
 	gEeprom.MrChannel[0]       = IS_MR_CHANNEL(Data[1])    ? Data[1] : MR_CHANNEL_FIRST;
@@ -561,8 +576,7 @@ void BOARD_EEPROM_Init(void)
 	#endif
 
 #ifdef ENABLE_FMRADIO
-	EEPROM_ReadBuffer(0x0E88, Data, 8);
-	memmove(&gEeprom.FM_FrequencyPlaying, Data, 2);
+	memmove(&gEeprom.FM_FrequencyPlaying, SETTINGS_IMAGE(0x0E88), 2);
 	// validate that its within the supported range
 	if(gEeprom.FM_FrequencyPlaying < FM_RADIO_MIN_FREQ || gEeprom.FM_FrequencyPlaying > FM_RADIO_MAX_FREQ)
 		gEeprom.FM_FrequencyPlaying = FM_RADIO_MIN_FREQ;
@@ -570,7 +584,7 @@ void BOARD_EEPROM_Init(void)
 #endif
 
 	// 0E90..0E97
-	EEPROM_ReadBuffer(0x0E90, Data, 8);
+	Data = SETTINGS_IMAGE(0x0E90);
 	gEeprom.BEEP_CONTROL                 = Data[0] & 1;
 	gEeprom.KEY_M_LONG_PRESS_ACTION      = ((Data[0] >> 1) < ACTION_OPT_LEN) ? (Data[0] >> 1) : ACTION_OPT_NONE;
 	gEeprom.KEY_1_SHORT_PRESS_ACTION     = (Data[1] < ACTION_OPT_LEN) ? Data[1] : ACTION_OPT_MONITOR;
@@ -583,12 +597,11 @@ void BOARD_EEPROM_Init(void)
 
 	// 0E98..0E9F
 	#ifdef ENABLE_PWRON_PASSWORD
-		EEPROM_ReadBuffer(0x0E98, Data, 8);
-		memmove(&gEeprom.POWER_ON_PASSWORD, Data, 4);
+		memmove(&gEeprom.POWER_ON_PASSWORD, SETTINGS_IMAGE(0x0E98), 4);
 	#endif
 
 	// 0EA0..0EA7
-	EEPROM_ReadBuffer(0x0EA0, Data, 8);
+	Data = SETTINGS_IMAGE(0x0EA0);
 	#ifdef ENABLE_VOX
 		gEeprom.VOX_DELAY = (Data[0] < 11) ? Data[0] : 4;
 	#endif
@@ -598,11 +611,21 @@ void BOARD_EEPROM_Init(void)
 	#endif
 	#ifdef ENABLE_MESSENGER
 		gEeprom.MESSENGER_CONFIG.__val = Data[3];
+		// digi used to be spare bits, an erased byte must not turn it on at WIDE7
+		if (gEeprom.MESSENGER_CONFIG.data.unused) {
+			gEeprom.MESSENGER_CONFIG.data.digi   = 0;
+			gEeprom.MESSENGER_CONFIG.data.unused = 0;
+		}
 		gEeprom.FSK_CONFIG.__val = Data[4];
+		// fec used to be a spare bit, an erased byte must not switch it on
+		if (gEeprom.FSK_CONFIG.data.unused) {
+			gEeprom.FSK_CONFIG.data.fec    = 0;
+			gEeprom.FSK_CONFIG.data.unused = 0;
+		}
 	#endif
 
 	// 0EA8..0EAF
-	EEPROM_ReadBuffer(0x0EA8, Data, 8);
+	Data = SETTINGS_IMAGE(0x0EA8);
 	#ifdef ENABLE_ALARM
 		gEeprom.ALARM_MODE                 = (Data[0] <  2) ? Data[0] : true;
 	#endif
@@ -612,7 +635,7 @@ void BOARD_EEPROM_Init(void)
 	gEeprom.BATTERY_TYPE                   = (Data[4] < BATTERY_TYPE_UNKNOWN) ? Data[4] : BATTERY_TYPE_1600_MAH;
 	gEeprom.SQL_TONE                       = (Data[5] <  ARRAY_SIZE(CTCSS_Options)) ? Data[5] : 50;
 	// 0ED0..0ED7
-	EEPROM_ReadBuffer(0x0ED0, Data, 8);
+	Data = SETTINGS_IMAGE(0x0ED0);
 	gEeprom.DTMF_SIDE_TONE               = (Data[0] <   2) ? Data[0] : true;
 
 #ifdef ENABLE_DTMF_CALLING
@@ -626,7 +649,7 @@ void BOARD_EEPROM_Init(void)
 	gEeprom.DTMF_HASH_CODE_PERSIST_TIME  = (Data[7] < 101) ? Data[7] * 10 : 100;
 
 	// 0ED8..0EDF
-	EEPROM_ReadBuffer(0x0ED8, Data, 8);
+	Data = SETTINGS_IMAGE(0x0ED8);
 	gEeprom.DTMF_CODE_PERSIST_TIME  = (Data[0] < 101) ? Data[0] * 10 : 100;
 	gEeprom.DTMF_CODE_INTERVAL_TIME = (Data[1] < 101) ? Data[1] * 10 : 100;
 #ifdef ENABLE_DTMF_CALLING
@@ -634,7 +657,7 @@ void BOARD_EEPROM_Init(void)
 
 	// 0EE0..0EE7
 
-	EEPROM_ReadBuffer(0x0EE0, Data, 8);
+	Data = SETTINGS_IMAGE(0x0EE0);
 	if (DTMF_ValidateCodes((char *)Data, 8))
 		memmove(gEeprom.ANI_DTMF_ID, Data, 8);
 	else
@@ -645,7 +668,7 @@ void BOARD_EEPROM_Init(void)
 
 
 	// 0EE8..0EEF
-	EEPROM_ReadBuffer(0x0EE8, Data, 8);
+	Data = SETTINGS_IMAGE(0x0EE8);
 	if (DTMF_ValidateCodes((char *)Data, 8))
 		memmove(gEeprom.KILL_CODE, Data, 8);
 	else
@@ -655,7 +678,7 @@ void BOARD_EEPROM_Init(void)
 	}
 
 	// 0EF0..0EF7
-	EEPROM_ReadBuffer(0x0EF0, Data, 8);
+	Data = SETTINGS_IMAGE(0x0EF0);
 	if (DTMF_ValidateCodes((char *)Data, 8))
 		memmove(gEeprom.REVIVE_CODE, Data, 8);
 	else
@@ -666,7 +689,7 @@ void BOARD_EEPROM_Init(void)
 #endif
 
 	// 0EF8..0F07
-	EEPROM_ReadBuffer(0x0EF8, Data, 16);
+	Data = SETTINGS_IMAGE(0x0EF8);
 	if (DTMF_ValidateCodes((char *)Data, 16))
 		memmove(gEeprom.DTMF_UP_CODE, Data, 16);
 	else
@@ -676,7 +699,7 @@ void BOARD_EEPROM_Init(void)
 	}
 
 	// 0F08..0F17
-	EEPROM_ReadBuffer(0x0F08, Data, 16);
+	Data = SETTINGS_IMAGE(0x0F08);
 	if (DTMF_ValidateCodes((char *)Data, 16))
 		memmove(gEeprom.DTMF_DOWN_CODE, Data, 16);
 	else
@@ -686,7 +709,7 @@ void BOARD_EEPROM_Init(void)
 	}
 
 	// 0F18..0F1F
-	EEPROM_ReadBuffer(0x0F18, Data, 8);
+	Data = SETTINGS_IMAGE(0x0F18);
 //	gEeprom.SCAN_LIST_DEFAULT = (Data[0] < 2) ? Data[0] : false;
 	gEeprom.SCAN_LIST_DEFAULT = (Data[0] < 3) ? Data[0] : false;  // we now have 'all' channel scan option
 	for (i = 0; i < 2; i++)
@@ -698,7 +721,7 @@ void BOARD_EEPROM_Init(void)
 	}
 
 	// 0F40..0F47
-	EEPROM_ReadBuffer(0x0F40, Data, 8);
+	Data = SETTINGS_IMAGE(0x0F40);
 	gSetting_F_LOCK            = (Data[0] < F_LOCK_LEN) ? Data[0] : F_LOCK_DEF;
 	gSetting_350TX             = (Data[1] < 2) ? Data[1] : false;  // was true
 #ifdef ENABLE_DTMF_CALLING
@@ -713,8 +736,7 @@ void BOARD_EEPROM_Init(void)
 	gSetting_battery_text      = (((Data[7] >> 2) & 3u) <= 2) ? (Data[7] >> 2) & 3 : 2;
 	gSetting_backlight_on_tx_rx = (Data[7] >> 6) & 3u;
 	// Read RxOffset setting
-	EEPROM_ReadBuffer(RX_OFFSET_ADDR, Data, 4);
-    memmove(&gEeprom.RX_OFFSET, Data, 4);
+	memmove(&gEeprom.RX_OFFSET, SETTINGS_IMAGE(RX_OFFSET_ADDR), 4);
 	// Make sure it inits with some sane value
 	gEeprom.RX_OFFSET = gEeprom.RX_OFFSET > RX_OFFSET_MAX ? 0 : gEeprom.RX_OFFSET;
 
@@ -724,8 +746,6 @@ void BOARD_EEPROM_Init(void)
 		gEeprom.ScreenChannel[1] = gEeprom.MrChannel[1];
 	}
 
-	// 0D60..0E27
-	EEPROM_ReadBuffer(0x0D60, gMR_ChannelAttributes, sizeof(gMR_ChannelAttributes));
 	for(uint16_t i = 0; i < sizeof(gMR_ChannelAttributes); i++) {
 		ChannelAttributes_t *att = &gMR_ChannelAttributes[i];
 		if(att->__val == 0xff){
@@ -733,47 +753,61 @@ void BOARD_EEPROM_Init(void)
 			att->band = 0xf;
 		}
 	}
+
+	#ifdef ENABLE_CHANNEL_CACHE
+		CHANNELS_Init();
+	#endif
 	#ifdef ENABLE_ENCRYPTION
 		// 0F30..0F3F - load encryption key
-		EEPROM_ReadBuffer(0x0F30, gEeprom.ENC_KEY, sizeof(gEeprom.ENC_KEY));
+		memcpy(gEeprom.ENC_KEY, SETTINGS_IMAGE(0x0F30), sizeof(gEeprom.ENC_KEY));
 	#endif
 
 	#ifdef ENABLE_APRS
 		// 0x0F18..0x0F30 load Callsign, SSID, Path1 and Path2
-		EEPROM_ReadBuffer(
-			0x0F18,
-			gEeprom.APRS_CONFIG.callsign,
-			CALLSIGN_SIZE + sizeof(uint8_t)
-		);
-		EEPROM_ReadBuffer(
-			0x0F20,
-			gEeprom.APRS_CONFIG.path1,
-			CALLSIGN_SIZE
-		);
-		EEPROM_ReadBuffer(
-			0x0F28,
-			gEeprom.APRS_CONFIG.path2,
-			CALLSIGN_SIZE
-		);
+		memcpy(gEeprom.APRS_CONFIG.callsign, SETTINGS_IMAGE(0x0F18), CALLSIGN_SIZE + sizeof(uint8_t));
+		memcpy(gEeprom.APRS_CONFIG.path1,    SETTINGS_IMAGE(0x0F20), CALLSIGN_SIZE);
+		memcpy(gEeprom.APRS_CONFIG.path2,    SETTINGS_IMAGE(0x0F28), CALLSIGN_SIZE);
 	#endif
 
 	#ifdef ENABLE_SPECTRUM_SHOW_CHANNEL_NAME
 		BOARD_gMR_LoadChannels();
 	#endif
 
+	#undef SETTINGS_IMAGE
 }
 #ifdef ENABLE_SPECTRUM_SHOW_CHANNEL_NAME
 // Load channel frequencies, names into global memory lookup table
+// Both tables have a 16 byte record per channel, so a handful of channels are
+// read per transaction instead of three small reads for every channel
 void BOARD_gMR_LoadChannels() {
-	uint8_t  i;
-	uint32_t freq_buf;
+	uint8_t      Records[8 * 16];
+	unsigned int i;
+	unsigned int j;
 
-	for (i = MR_CHANNEL_FIRST; i <= MR_CHANNEL_LAST; i++)
+	for (i = MR_CHANNEL_FIRST; i <= MR_CHANNEL_LAST; i += 8)
 	{
-		freq_buf = BOARD_fetchChannelFrequency(i);
+		const unsigned int Count = MIN(8u, MR_CHANNEL_LAST + 1u - i);
 
-		gMR_ChannelFrequencyAttributes[i].Frequency = RX_freq_check(freq_buf) == -1 ? 0 : freq_buf;
-		SETTINGS_FetchChannelName(gMR_ChannelFrequencyAttributes[i].Name, i);
+		// 0000..0C7F
+		EEPROM_ReadBuffer(i * 16, Records, Count * 16);
+		for (j = 0; j < Count; j++)
+		{
+			uint32_t freq_buf;
+
+			memcpy(&freq_buf, &Records[j * 16], 4);
+			gMR_ChannelFrequencyAttributes[i + j].Frequency = RX_freq_check(freq_buf) == -1 ? 0 : freq_buf;
+		}
+
+		// 0F50..1BCF
+		EEPROM_ReadBuffer(0x0F50 + (i * 16), Records, Count * 16);
+		for (j = 0; j < Count; j++)
+		{
+			char *pName = gMR_ChannelFrequencyAttributes[i + j].Name;
+
+			memset(pName, 0, sizeof(gMR_ChannelFrequencyAttributes[i + j].Name));
+			if (RADIO_CheckValidChannel(i + j, false, 0))
+				SETTINGS_CopyChannelName(pName, &Records[j * 16]);
+		}
 	}
 }
 #endif
@@ -842,6 +876,11 @@ uint32_t BOARD_fetchChannelFrequency(const int channel)
 		uint32_t offset;
 	} __attribute__((packed)) info;
 
+	#ifdef ENABLE_CHANNEL_CACHE
+		if (IS_MR_CHANNEL(channel))
+			return CHANNELS_Get(channel)->Frequency;
+	#endif
+
 	EEPROM_ReadBuffer(channel * 16, &info, sizeof(info));
 
 	return info.frequency;
@@ -849,12 +888,16 @@ uint32_t BOARD_fetchChannelFrequency(const int channel)
 #ifdef ENABLE_SPECTRUM_SHOW_CHANNEL_NAME
 	int BOARD_gMR_fetchChannel(const uint32_t freq)
 	{
-		for (int i = MR_CHANNEL_FIRST; i <= MR_CHANNEL_LAST; i++) {
-			if (gMR_ChannelFrequencyAttributes[i].Frequency == freq)
-				return i;
-		}
-		// Return -1 if no channel found
-		return -1;
+		#ifdef ENABLE_CHANNEL_CACHE
+			return CHANNELS_FindByFrequency(freq);
+		#else
+			for (int i = MR_CHANNEL_FIRST; i <= MR_CHANNEL_LAST; i++) {
+				if (gMR_ChannelFrequencyAttributes[i].Frequency == freq)
+					return i;
+			}
+			// Return -1 if no channel found
+			return -1;
+		#endif
 	}
 #endif
 
@@ -887,6 +930,13 @@ void BOARD_FactoryReset(bool bIsAll)
 		}
 	}
 
+	#ifdef ENABLE_ACTIVITY_LOG
+		// the loop above leaves the contacts area alone, the log lives there
+		ACTIVITY_Erase();
+	#endif
+
+	EEPROM_Flush();
+
 	if (bIsAll)
 	{
 		RADIO_InitInfo(gRxVfo, FREQ_CHANNEL_FIRST + BAND6_400MHz, 43350000);
@@ -906,6 +956,7 @@ void BOARD_FactoryReset(bool bIsAll)
 			SETTINGS_SaveChannel(MR_CHANNEL_FIRST + i, 0, gRxVfo, 2);
 		}
 		// reboot device
+		EEPROM_Flush();
 		NVIC_SystemReset();
 	}
 }
@@ -0,0 +1,233 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <string.h>
+
+#include "channels.h"
+#include "driver/eeprom.h"
+#include "misc.h"
+#include "radio.h"
+
+#define CHANNEL_COUNT (MR_CHANNEL_LAST + 1)
+
+static CHANNEL_Record_t gRecords[CHANNEL_COUNT];
+static uint32_t         gRecordLoaded[(CHANNEL_COUNT + 31) / 32];
+
+// next channel the background loader looks at, CHANNEL_COUNT once it went through all of them
+static uint8_t          gLoadNext;
+
+// the loaded valid channels sorted by frequency, ties in channel order
+static uint8_t          gByFrequency[CHANNEL_COUNT];
+static uint8_t          gByFrequencyCount;
+
+// members of every list, a bit per channel
+static uint32_t         gMembers[CHANNEL_LIST_COUNT][(CHANNEL_COUNT + 31) / 32];
+static uint8_t          gMemberCount[CHANNEL_LIST_COUNT];
+
+static bool CHANNELS_IsLoaded(const uint8_t Channel)
+{
+	return (gRecordLoaded[Channel / 32] >> (Channel % 32)) & 1u;
+}
+
+static bool CHANNELS_InList(const uint8_t Channel, const uint8_t List)
+{
+	return RADIO_CheckValidChannel(Channel, List != CHANNEL_LIST_ALL, List - CHANNEL_LIST_1);
+}
+
+static void CHANNELS_Unindex(const uint8_t Channel)
+{
+	unsigned int i;
+
+	for (i = 0; i < gByFrequencyCount; i++)
+	{
+		if (gByFrequency[i] == Channel)
+		{
+			gByFrequencyCount--;
+			memmove(&gByFrequency[i], &gByFrequency[i + 1], gByFrequencyCount - i);
+			return;
+		}
+	}
+}
+
+static void CHANNELS_Index(const uint8_t Channel)
+{
+	const uint32_t Frequency = gRecords[Channel].Frequency;
+	unsigned int   i;
+
+	for (i = gByFrequencyCount++; i > 0; i--)
+	{
+		const uint8_t Other = gByFrequency[i - 1];
+
+		if (gRecords[Other].Frequency < Frequency || (gRecords[Other].Frequency == Frequency && Other < Channel))
+			break;
+		gByFrequency[i] = Other;
+	}
+	gByFrequency[i] = Channel;
+}
+
+static void CHANNELS_Read(const uint8_t Channel)
+{
+	CHANNEL_Record_t *pRecord = &gRecords[Channel];
+
+	if (CHANNELS_IsLoaded(Channel))
+		CHANNELS_Unindex(Channel);
+
+	// 0000..0C7F, frequency, offset and the rest of the record are contiguous
+	EEPROM_ReadBuffer(Channel * 16, pRecord, 16);
+	// 0F50..1BCF
+	EEPROM_ReadBuffer(0x0F50 + (Channel * 16), pRecord->Name, sizeof(pRecord->Name));
+
+	gRecordLoaded[Channel / 32] |= 1u << (Channel % 32);
+
+	if (RADIO_CheckValidChannel(Channel, false, 0))
+		CHANNELS_Index(Channel);
+}
+
+static void CHANNELS_BuildLists(void)
+{
+	unsigned int List;
+	unsigned int i;
+
+	memset(gMembers, 0, sizeof(gMembers));
+	memset(gMemberCount, 0, sizeof(gMemberCount));
+
+	for (List = 0; List < CHANNEL_LIST_COUNT; List++)
+	{
+		for (i = 0; i < CHANNEL_COUNT; i++)
+		{
+			if (CHANNELS_InList(i, List))
+			{
+				gMembers[List][i / 32] |= 1u << (i % 32);
+				gMemberCount[List]++;
+			}
+		}
+	}
+}
+
+// first member at or next to 'Channel' in 'Direction', the list must not be empty
+static uint8_t CHANNELS_Find(const uint32_t *pMembers, unsigned int Channel, const int8_t Direction)
+{
+	while (1)
+	{
+		const uint32_t Word = pMembers[Channel / 32];
+
+		if ((Word >> (Channel % 32)) & 1u)
+			return Channel;
+
+		// words without a member further on are skipped whole
+		if (Direction > 0)
+		{
+			Channel = (Word >> (Channel % 32)) ? Channel + 1 : (Channel | 31u) + 1;
+			if (Channel >= CHANNEL_COUNT)
+				Channel = 0;
+		}
+		else
+		if (Word << (31 - (Channel % 32)))
+			Channel--;
+		else
+			Channel = (Channel < 32) ? CHANNEL_COUNT - 1 : (Channel & ~31u) - 1;
+	}
+}
+
+void CHANNELS_Init(void)
+{
+	CHANNELS_Invalidate();
+}
+
+void CHANNELS_LoadNext(void)
+{
+	while (gLoadNext < CHANNEL_COUNT)
+	{
+		const uint8_t Channel = gLoadNext++;
+
+		// unused channels are only read if somebody asks for them
+		if (!CHANNELS_IsLoaded(Channel) && RADIO_CheckValidChannel(Channel, false, 0))
+		{
+			CHANNELS_Read(Channel);
+			return;
+		}
+	}
+}
+
+void CHANNELS_Invalidate(void)
+{
+	memset(gRecordLoaded, 0, sizeof(gRecordLoaded));
+	gLoadNext         = 0;
+	gByFrequencyCount = 0;
+
+	CHANNELS_BuildLists();
+}
+
+void CHANNELS_Update(uint8_t Channel)
+{
+	if (!IS_MR_CHANNEL(Channel))
+		return;
+
+	CHANNELS_Read(Channel);
+	CHANNELS_BuildLists();
+}
+
+const CHANNEL_Record_t *CHANNELS_Get(uint8_t Channel)
+{
+	if (!CHANNELS_IsLoaded(Channel))
+		CHANNELS_Read(Channel);
+
+	return &gRecords[Channel];
+}
+
+uint8_t CHANNELS_Step(uint8_t Channel, int8_t Direction, uint8_t List)
+{
+	if (Channel == 0xFF)
+		Channel = MR_CHANNEL_LAST;
+	else
+	if (!IS_MR_CHANNEL(Channel))
+		Channel = MR_CHANNEL_FIRST;
+
+	if (Direction == 0)
+		return CHANNELS_InList(Channel, List) ? Channel : 0xFF;
+
+	if (gMemberCount[List] == 0)
+		return 0xFF;
+
+	return CHANNELS_Find(gMembers[List], Channel, Direction);
+}
+
+int CHANNELS_FindByFrequency(uint32_t Frequency)
+{
+	unsigned int Low  = 0;
+	unsigned int High;
+
+	// pull in one more record, the spectrum keeps the main loop and with it
+	// the background loader from running while it looks up channels
+	CHANNELS_LoadNext();
+	High = gByFrequencyCount;
+
+	// lower bound, so the lowest numbered channel wins a tie
+	while (Low < High)
+	{
+		const unsigned int Mid = (Low + High) / 2;
+
+		if (gRecords[gByFrequency[Mid]].Frequency < Frequency)
+			Low = Mid + 1;
+		else
+			High = Mid;
+	}
+
+	if (Low < gByFrequencyCount && gRecords[gByFrequency[Low]].Frequency == Frequency)
+		return gByFrequency[Low];
+
+	return -1;
+}
@@ -0,0 +1,57 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef CHANNELS_H
+#define CHANNELS_H
+
+#include <stdint.h>
+
+// RAM copy of the memory channel records, so that selecting, stepping and
+// looking up channels doesn't go out on the I2C bus every time
+
+typedef struct
+{
+	uint32_t Frequency;
+	uint32_t Offset;
+	uint8_t  Data[8];    // codes, modulation, flags, step and scrambler as laid out at +8 in EEPROM
+	char     Name[10];   // as stored, only terminated when shorter than 10 chars
+} __attribute__((packed)) CHANNEL_Record_t;
+
+enum CHANNEL_List_t
+{
+	CHANNEL_LIST_ALL = 0,  // every valid channel
+	CHANNEL_LIST_1,        // channels in scan list 1
+	CHANNEL_LIST_2,        // channels in scan list 2
+	CHANNEL_LIST_COUNT
+};
+
+// call once gMR_ChannelAttributes is loaded, records are filled in the background afterwards
+void                    CHANNELS_Init(void);
+// loads one more record if any are missing, cheap enough for every 10ms tick
+void                    CHANNELS_LoadNext(void);
+// drops everything, e.g. after the EEPROM was written behind our back
+void                    CHANNELS_Invalidate(void);
+// re-reads a channel after it was saved or its attributes changed
+void                    CHANNELS_Update(uint8_t Channel);
+
+const CHANNEL_Record_t *CHANNELS_Get(uint8_t Channel);
+// first channel of the list at or next to 'Channel' in 'Direction', 0xFF if the list is empty
+uint8_t                 CHANNELS_Step(uint8_t Channel, int8_t Direction, uint8_t List);
+// lowest numbered valid channel on 'Frequency', -1 if there is none or the
+// background loader hasn't got to it yet, every call loads one more record
+int                     CHANNELS_FindByFrequency(uint32_t Frequency);
+
+#endif
@@ -41,7 +41,9 @@ extern const uint16_t CTCSS_Options[55];
 extern const uint16_t DCS_Options[104];
 
 uint32_t DCS_GetGolayCodeWord(DCS_CodeType_t CodeType, uint8_t Option);
-uint8_t DCS_GetCdcssCode(uint32_t Code);
+// 'Code' may be any rotation of a code word of either polarity, a word that
+// reads as a normal code word in some rotation is reported as normal
+uint8_t DCS_FindCdcssCode(uint32_t Code, DCS_CodeType_t *pCodeType);
 uint8_t DCS_GetCtcssCode(int Code);
 
 #endif
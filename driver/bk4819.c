@@ -18,6 +18,7 @@
  */
 
 #include <stdio.h>   // NULL
+#include <string.h>
 
 #include "audio.h"
 #include "bk4819.h"
@@ -41,29 +42,70 @@ static uint16_t gBK4819_GpioOutState;
 
 bool gRxIdleMode;
 
+uint32_t gBK4819_BusWrites;
+uint16_t gBK4819_OperationWrites[BK4819_OP_COUNT];
+
+#ifdef ENABLE_BK4819_SHADOW
+	// Shadow slot + 1 for every register that reads back exactly what was last
+	// written to it. Anything not listed here is volatile and always goes to the
+	// chip: status/indicator registers (02, 0B..0E, 5F, 63..6F, 7E), multiplexed
+	// ones where the value selects a sub-register (07, 08, 09), and ones with
+	// self-clearing or strobe bits (00 soft reset, 30 enables, 59 FIFO clear).
+	static const uint8_t BK4819_ShadowSlot[0x80] = {
+		[0x10] =  1, [0x11] =  2, [0x12] =  3, [0x13] =  4, [0x14] =  5,
+		[0x19] =  6, [0x1F] =  7, [0x20] =  8, [0x21] =  9, [0x24] = 10,
+		[0x28] = 11, [0x29] = 12, [0x2B] = 13, [0x31] = 14, [0x32] = 15,
+		[0x33] = 16, [0x36] = 17, [0x37] = 18, [0x38] = 19, [0x39] = 20,
+		[0x3A] = 21, [0x3B] = 22, [0x3C] = 23, [0x3D] = 24, [0x3E] = 25,
+		[0x3F] = 26, [0x40] = 27, [0x43] = 28, [0x46] = 29, [0x47] = 30,
+		[0x48] = 31, [0x49] = 32, [0x4D] = 33, [0x4E] = 34, [0x4F] = 35,
+		[0x50] = 36, [0x51] = 37, [0x52] = 38, [0x58] = 39, [0x5A] = 40,
+		[0x5B] = 41, [0x5C] = 42, [0x5D] = 43, [0x5E] = 44, [0x70] = 45,
+		[0x71] = 46, [0x72] = 47, [0x73] = 48, [0x78] = 49, [0x79] = 50,
+		[0x7A] = 51, [0x7B] = 52, [0x7C] = 53, [0x7D] = 54,
+	};
+	#define BK4819_SHADOW_SLOTS 54
+
+	static uint16_t gBK4819_Shadow[BK4819_SHADOW_SLOTS];
+	static uint32_t gBK4819_ShadowValid[(BK4819_SHADOW_SLOTS + 31) / 32];
+
+	uint32_t gBK4819_ReadsSaved;
+	uint32_t gBK4819_WritesSaved;
+
+	static void BK4819_InvalidateShadow(void)
+	{
+		memset(gBK4819_ShadowValid, 0, sizeof(gBK4819_ShadowValid));
+	}
+
+	static inline bool BK4819_ShadowIsValid(const uint8_t index)
+	{
+		return (gBK4819_ShadowValid[index >> 5] >> (index & 31)) & 1u;
+	}
+
+	static inline void BK4819_ShadowStore(const uint8_t index, const uint16_t value)
+	{
+		gBK4819_Shadow[index] = value;
+		gBK4819_ShadowValid[index >> 5] |= 1u << (index & 31);
+	}
+#endif
+
 __inline uint16_t scale_freq(const uint16_t freq)
 {
 //	return (((uint32_t)freq * 1032444u) + 50000u) / 100000u;   // with rounding
 	return (((uint32_t)freq * 1353245u) + (1u << 16)) >> 17;   // with rounding
 }
 
-void BK4819_Init(void)
+static const BK4819_RegisterWrite_t BK4819_InitTable[] =
 {
-	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
-	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
-	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
+	BK4819_REG_WRITE(BK4819_REG_37, 0x1D0F),
+	BK4819_REG_WRITE(BK4819_REG_36, 0x0022),
 
-	BK4819_WriteRegister(BK4819_REG_00, 0x8000);
-	BK4819_WriteRegister(BK4819_REG_00, 0x0000);
+	// BK4819_SetDefaultAmplifierSettings()
+	BK4819_REG_WRITE(BK4819_REG_13, 0x03BE),
 
-	BK4819_WriteRegister(BK4819_REG_37, 0x1D0F);
-	BK4819_WriteRegister(BK4819_REG_36, 0x0022);
+	BK4819_REG_WRITE(BK4819_REG_19, 0b0001000001000001),   // <15> MIC AGC  1 = disable  0 = enable
 
-	BK4819_SetDefaultAmplifierSettings();
-
-	BK4819_WriteRegister(BK4819_REG_19, 0b0001000001000001);   // <15> MIC AGC  1 = disable  0 = enable
-
-	BK4819_WriteRegister(BK4819_REG_7D, 0xE940);
+	BK4819_REG_WRITE(BK4819_REG_7D, 0xE940),
 
 	// REG_48 .. RX AF level
 	//
@@ -83,11 +125,38 @@ void BK4819_Init(void)
 	//         15 = max
 	//          0 = min
 	//
-	BK4819_WriteRegister(BK4819_REG_48,	//  0xB3A8);     // 1011 00 111010 1000
+	BK4819_REG_WRITE(BK4819_REG_48,	//  0xB3A8);     // 1011 00 111010 1000
 		(11u << 12) |     // ??? 0..15
 		( 0u << 10) |     // AF Rx Gain-1
 		(58u <<  4) |     // AF Rx Gain-2
-		( 8u <<  0));     // AF DAC Gain (after Gain-1 and Gain-2)
+		( 8u <<  0)),     // AF DAC Gain (after Gain-1 and Gain-2)
+};
+
+static const BK4819_RegisterWrite_t BK4819_InitTailTable[] =
+{
+	BK4819_REG_WRITE(BK4819_REG_1F, 0x5454),
+	BK4819_REG_WRITE(BK4819_REG_3E, 0xA037),
+	BK4819_REG_WRITE(BK4819_REG_33, 0x9000),   // gBK4819_GpioOutState
+	BK4819_REG_WRITE(BK4819_REG_3F, 0),
+};
+
+void BK4819_Init(void)
+{
+	const uint32_t BusWrites = gBK4819_BusWrites;
+
+	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
+	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
+	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
+
+	BK4819_WriteRegister(BK4819_REG_00, 0x8000);
+	BK4819_WriteRegister(BK4819_REG_00, 0x0000);
+
+	#ifdef ENABLE_BK4819_SHADOW
+		// soft reset, everything is back to power-on defaults
+		BK4819_InvalidateShadow();
+	#endif
+
+	BK4819_WriteRegisters(BK4819_InitTable, ARRAY_SIZE(BK4819_InitTable));
 
 #if 1
 	const uint8_t dtmf_coeffs[] = {111, 107, 103, 98, 80, 71, 58, 44, 65, 55, 37, 23, 228, 203, 181, 159};
@@ -113,13 +182,11 @@ void BK4819_Init(void)
 	BK4819_WriteRegister(BK4819_REG_09, 0xF09F);  // 9F
 #endif
 
-	BK4819_WriteRegister(BK4819_REG_1F, 0x5454);
-	BK4819_WriteRegister(BK4819_REG_3E, 0xA037);
-
 	gBK4819_GpioOutState = 0x9000;
 
-	BK4819_WriteRegister(BK4819_REG_33, 0x9000);
-	BK4819_WriteRegister(BK4819_REG_3F, 0);
+	BK4819_WriteRegisters(BK4819_InitTailTable, ARRAY_SIZE(BK4819_InitTailTable));
+
+	gBK4819_OperationWrites[BK4819_OP_INIT] = gBK4819_BusWrites - BusWrites;
 }
 
 static uint16_t BK4819_ReadU16(void)
@@ -151,6 +218,15 @@ uint16_t BK4819_ReadRegister(BK4819_REGISTER_t Register)
 {
 	uint16_t Value;
 
+	#ifdef ENABLE_BK4819_SHADOW
+		const uint8_t slot = Register < 0x80 ? BK4819_ShadowSlot[Register] : 0;
+		if (slot && BK4819_ShadowIsValid(slot - 1))
+		{
+			gBK4819_ReadsSaved++;
+			return gBK4819_Shadow[slot - 1];
+		}
+	#endif
+
 	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
 	GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
 
@@ -166,11 +242,18 @@ uint16_t BK4819_ReadRegister(BK4819_REGISTER_t Register)
 	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
 	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
 
+	#ifdef ENABLE_BK4819_SHADOW
+		if (slot)
+			BK4819_ShadowStore(slot - 1, Value);
+	#endif
+
 	return Value;
 }
 
-void BK4819_WriteRegister(BK4819_REGISTER_t Register, uint16_t Data)
+static void BK4819_BusWrite(BK4819_REGISTER_t Register, uint16_t Data)
 {
+	gBK4819_BusWrites++;
+
 	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
 	GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
 
@@ -193,6 +276,39 @@ void BK4819_WriteRegister(BK4819_REGISTER_t Register, uint16_t Data)
 	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
 }
 
+void BK4819_WriteRegister(BK4819_REGISTER_t Register, uint16_t Data)
+{
+	#ifdef ENABLE_BK4819_SHADOW
+		const uint8_t slot = Register < 0x80 ? BK4819_ShadowSlot[Register] : 0;
+		if (slot)
+		{
+			if (BK4819_ShadowIsValid(slot - 1) && gBK4819_Shadow[slot - 1] == Data)
+			{
+				gBK4819_WritesSaved++;
+				return;
+			}
+			BK4819_ShadowStore(slot - 1, Data);
+		}
+	#endif
+
+	BK4819_BusWrite(Register, Data);
+}
+
+void BK4819_WriteRegisters(const BK4819_RegisterWrite_t *pTable, unsigned int Count)
+{
+	for (; Count > 0; Count--, pTable++)
+	{
+		uint16_t Value = pTable->Value;
+
+		// partial entries are merged with the current contents, which
+		// the shadow usually has without going to the chip
+		if (pTable->Mask != 0xFFFFu)
+			Value = (BK4819_ReadRegister(pTable->Register) & ~pTable->Mask) | (Value & pTable->Mask);
+
+		BK4819_WriteRegister(pTable->Register, Value);
+	}
+}
+
 void BK4819_WriteU8(uint8_t Data)
 {
 	unsigned int i;
@@ -266,8 +382,19 @@ void BK4819_SetAGC(bool enable)
 	// }
 }
 
+// switched values to ones from 1o11 am_fix:
+static const BK4819_RegisterWrite_t BK4819_AgcGainTable[] =
+{
+	BK4819_REG_WRITE(BK4819_REG_12, 0x0393),  // 0x037B / 000000 11 011 11 011 / -24dB
+	BK4819_REG_WRITE(BK4819_REG_11, 0x01B5),  // 0x027B / 000000 10 011 11 011 / -43dB
+	BK4819_REG_WRITE(BK4819_REG_10, 0x0145),  // 0x007A / 000000 00 011 11 010 / -58dB
+	BK4819_REG_WRITE(BK4819_REG_14, 0x0019),  // 0x0019 / 000000 00 000 11 001 / -84dB
+};
+
 void BK4819_InitAGC(const uint8_t agcType, ModulationMode_t modulation)
 {
+	const uint32_t BusWrites = gBK4819_BusWrites;
+
 	// REG_10, REG_11, REG_12 REG_13, REG_14
 	//
 	// Rx AGC Gain Table[]. (Index Max->Min is 3,2,1,0,-1)
@@ -337,11 +464,9 @@ void BK4819_InitAGC(const uint8_t agcType, ModulationMode_t modulation)
 				return;
 		}
 	}
-	// switched values to ones from 1o11 am_fix:
-	BK4819_WriteRegister(BK4819_REG_12, 0x0393);  // 0x037B / 000000 11 011 11 011 / -24dB
-	BK4819_WriteRegister(BK4819_REG_11, 0x01B5);  // 0x027B / 000000 10 011 11 011 / -43dB
-	BK4819_WriteRegister(BK4819_REG_10, 0x0145);  // 0x007A / 000000 00 011 11 010 / -58dB
-	BK4819_WriteRegister(BK4819_REG_14, 0x0019);  // 0x0019 / 000000 00 000 11 001 / -84dB
+	BK4819_WriteRegisters(BK4819_AgcGainTable, ARRAY_SIZE(BK4819_AgcGainTable));
+
+	gBK4819_OperationWrites[BK4819_OP_AGC] = gBK4819_BusWrites - BusWrites;
 	//30, 10 - doesn't overload but sound low
 	//50, 10 - best so far
 	//50, 15, - SOFT - signal doesn't fall too low - works best for now
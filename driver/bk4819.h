@@ -68,12 +68,45 @@ enum BK4819_CssScanResult_t
 
 typedef enum BK4819_CssScanResult_t BK4819_CssScanResult_t;
 
+// one entry of a register batch, only the bits set in Mask are changed
+typedef struct
+{
+	uint8_t  Register;
+	uint16_t Value;
+	uint16_t Mask;
+} BK4819_RegisterWrite_t;
+
+#define BK4819_REG_WRITE(reg, value)         { (reg), (value), 0xFFFFu }
+#define BK4819_REG_UPDATE(reg, value, mask)  { (reg), (value), (mask) }
+
+// operations whose bus writes are counted, see gBK4819_OperationWrites
+enum BK4819_Operation_t
+{
+	BK4819_OP_INIT = 0,   // BK4819_Init
+	BK4819_OP_AGC,        // BK4819_InitAGC
+	BK4819_OP_SETUP,      // RADIO_SetupRegisters
+	BK4819_OP_FSK,        // FSK_configure
+	BK4819_OP_COUNT
+};
+
 // radio is asleep, not listening
 extern bool gRxIdleMode;
 
+// register writes that actually went out on the bus
+extern uint32_t gBK4819_BusWrites;
+// bus writes of the last run of each BK4819_Operation_t
+extern uint16_t gBK4819_OperationWrites[BK4819_OP_COUNT];
+
+#ifdef ENABLE_BK4819_SHADOW
+	// bus transactions answered from / skipped thanks to the register shadow
+	extern uint32_t gBK4819_ReadsSaved;
+	extern uint32_t gBK4819_WritesSaved;
+#endif
+
 void     BK4819_Init(void);
 uint16_t BK4819_ReadRegister(BK4819_REGISTER_t Register);
 void     BK4819_WriteRegister(BK4819_REGISTER_t Register, uint16_t Data);
+void     BK4819_WriteRegisters(const BK4819_RegisterWrite_t *pTable, unsigned int Count);
 void     BK4819_SetRegValue(RegisterSpec s, uint16_t v);
 void     BK4819_WriteU8(uint8_t Data);
 void     BK4819_WriteU16(uint16_t Data);
@@ -23,11 +23,26 @@
 #include "driver/eeprom.h"
 #include "driver/i2c.h"
 #include "driver/system.h"
+#include "driver/systick.h"
 
 // EEPROM calibration tables start here
 #define EEPROM_WRITE_MAX_ADDR 0x1E00
 
-void EEPROM_ReadBuffer(uint16_t Address, void *pBuffer, uint8_t Size)
+// BL24C64, a page write must not cross one of these
+#define EEPROM_PAGE_SIZE      32
+
+// dirty 8 byte blocks waiting to be burnt in
+#define EEPROM_CACHE_BLOCKS   16
+
+typedef struct {
+	uint16_t Address;
+	uint8_t  Data[8];
+} EEPROM_Block_t;
+
+static EEPROM_Block_t gCache[EEPROM_CACHE_BLOCKS];
+static uint8_t        gCacheCount;
+
+void EEPROM_ReadBuffer(uint16_t Address, void *pBuffer, uint16_t Size)
 {
 	I2C_Start();
 
@@ -43,6 +58,110 @@ void EEPROM_ReadBuffer(uint16_t Address, void *pBuffer, uint8_t Size)
 	I2C_ReadBuffer(pBuffer, Size);
 
 	I2C_Stop();
+
+	// what's still in the cache is newer than the chip
+	for (unsigned int i = 0; i < gCacheCount; i++)
+	{
+		const EEPROM_Block_t *pBlock = &gCache[i];
+		const uint16_t        Start  = (pBlock->Address > Address) ? pBlock->Address : Address;
+		const uint16_t        End    = (pBlock->Address + 8u < Address + Size) ? pBlock->Address + 8u : Address + Size;
+
+		if (Start < End)
+			memcpy((uint8_t *)pBuffer + (Start - Address), pBlock->Data + (Start - pBlock->Address), End - Start);
+	}
+}
+
+// wait for the end of the internal write cycle, the chip doesn't ACK its address until then
+static void EEPROM_WaitReady(void)
+{
+	for (unsigned int i = 0; i < 100; i++)
+	{
+		I2C_Start();
+		const int ret = I2C_Write(0xA0);
+		I2C_Stop();
+
+		if (ret == 0)
+			return;
+
+		SYSTICK_DelayUs(100);
+	}
+}
+
+// writes a run that doesn't cross a page, unless the chip already holds it
+static void EEPROM_WritePage(uint16_t Address, const uint8_t *pData, uint8_t Size)
+{
+	uint8_t buffer[EEPROM_PAGE_SIZE];
+
+	I2C_Start();
+	I2C_Write(0xA0);
+	I2C_Write((Address >> 8) & 0xFF);
+	I2C_Write((Address >> 0) & 0xFF);
+	I2C_Start();
+	I2C_Write(0xA1);
+	I2C_ReadBuffer(buffer, Size);
+	I2C_Stop();
+
+	if (memcmp(pData, buffer, Size) == 0)
+		return;
+
+	I2C_Start();
+	I2C_Write(0xA0);
+	I2C_Write((Address >> 8) & 0xFF);
+	I2C_Write((Address >> 0) & 0xFF);
+	I2C_WriteBuffer(pData, Size);
+	I2C_Stop();
+
+	EEPROM_WaitReady();
+}
+
+void EEPROM_Flush(void)
+{
+	uint8_t      run[EEPROM_PAGE_SIZE];
+	unsigned int i;
+
+	if (gCacheCount == 0)
+		return;
+
+	// sort by address so neighbouring blocks can share a page write
+	for (i = 1; i < gCacheCount; i++)
+	{
+		const EEPROM_Block_t Block = gCache[i];
+		unsigned int         j     = i;
+
+		for (; j > 0 && gCache[j - 1].Address > Block.Address; j--)
+			gCache[j] = gCache[j - 1];
+		gCache[j] = Block;
+	}
+
+	i = 0;
+	while (i < gCacheCount)
+	{
+		const uint16_t Address = gCache[i].Address;
+		unsigned int   Size    = 0;
+
+		// merge following blocks as long as the run stays within a page
+		while (i < gCacheCount &&
+		       gCache[i].Address == Address + Size &&
+		       (Address / EEPROM_PAGE_SIZE) == ((Address + Size + 7u) / EEPROM_PAGE_SIZE))
+		{
+			memcpy(run + Size, gCache[i].Data, 8);
+			Size += 8;
+			i++;
+		}
+
+		if (Size == 0)
+		{	// an unaligned block straddling two pages
+			const uint8_t First = EEPROM_PAGE_SIZE - (Address % EEPROM_PAGE_SIZE);
+			EEPROM_WritePage(Address, gCache[i].Data, First);
+			EEPROM_WritePage(Address + First, gCache[i].Data + First, 8 - First);
+			i++;
+			continue;
+		}
+
+		EEPROM_WritePage(Address, run, Size);
+	}
+
+	gCacheCount = 0;
 }
 
 /*
@@ -50,24 +169,34 @@ Writes to EEPROM
 Address: EEPROM address
 pBuffer: value
 safe: if set to false will allow overwriting calibration data
+
+The 8 bytes are only queued, they reach the chip on the next EEPROM_Flush()
 */
 void EEPROM_WriteBuffer(uint16_t Address, const void *pBuffer, const bool safe)
 {
 	if (pBuffer == NULL || (safe && Address >= EEPROM_WRITE_MAX_ADDR))
 		return;
 
-	uint8_t buffer[8];
-	EEPROM_ReadBuffer(Address, buffer, 8);
-	if (memcmp(pBuffer, buffer, 8) != 0)
+	for (unsigned int i = 0; i < gCacheCount; i++)
 	{
-		I2C_Start();
-		I2C_Write(0xA0);
-		I2C_Write((Address >> 8) & 0xFF);
-		I2C_Write((Address >> 0) & 0xFF);
-		I2C_WriteBuffer(pBuffer, 8);
-		I2C_Stop();
+		if (gCache[i].Address == Address)
+		{
+			memcpy(gCache[i].Data, pBuffer, 8);
+			return;
+		}
+
+		// a partial overlap would make the flush order matter
+		if (gCache[i].Address < Address + 8u && Address < gCache[i].Address + 8u)
+		{
+			EEPROM_Flush();
+			break;
+		}
 	}
 
-	// give the EEPROM time to burn the data in (apparently takes 5ms)
-	SYSTEM_DelayMs(8);
+	if (gCacheCount >= EEPROM_CACHE_BLOCKS)
+		EEPROM_Flush();
+
+	gCache[gCacheCount].Address = Address;
+	memcpy(gCache[gCacheCount].Data, pBuffer, 8);
+	gCacheCount++;
 }
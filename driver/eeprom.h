@@ -23,8 +23,10 @@
 #include <stdint.h>
 #include <stdbool.h>
 
-void EEPROM_ReadBuffer(uint16_t Address, void *pBuffer, uint8_t Size);
+void EEPROM_ReadBuffer(uint16_t Address, void *pBuffer, uint16_t Size);
 void EEPROM_WriteBuffer(uint16_t Address, const void *pBuffer, const bool safe);
+// burns in the queued writes, APP_TimeSlice500ms calls it for everyone else
+void EEPROM_Flush(void);
 
 #endif
 
@@ -19,6 +19,7 @@
 
 #include <stdint.h>
 #include <stdio.h>     // NULL
+#include <string.h>
 
 #include "bsp/dp32g030/gpio.h"
 #include "bsp/dp32g030/spi.h"
@@ -31,10 +32,144 @@
 uint8_t gStatusLine[128];
 uint8_t gFrameBuffer[7][128];
 
+// changed column span of each gFrameBuffer line, first > last when unchanged
+static uint8_t gDirtyFirst[7] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+static uint8_t gDirtyLast[7];
+
+// bit ST7565_LINES in gPendingLines stands for the status line
+#define ST7565_LINES          ARRAY_SIZE(gFrameBuffer)
+#define ST7565_STATUS_LINE    ST7565_LINES
+
+// polls of the TX busy bit before giving up on it, as SPI_WaitForUndocumentedTxFifoStatusBit does
+#define ST7565_DRAIN_POLLS    100000u
+
+enum {
+	ST7565_STEP_IDLE = 0,
+	ST7565_STEP_ADDRESS,  // page and column going out with A0 low
+	ST7565_STEP_DATA,     // columns going out with A0 high
+	ST7565_STEP_END,      // waiting for the last column to leave before letting go of the bus
+};
+
+// lines handed to ST7565_Pump that haven't been started yet
+static uint8_t gPendingLines;
+static uint8_t gStep = ST7565_STEP_IDLE;
+static uint8_t gLine = ST7565_STATUS_LINE;
+static uint8_t gColumn;
+static uint8_t gLastColumn;
+static uint32_t gDrainPolls;
+
+static bool ST7565_TxDraining(void)
+{
+	// same undocumented bit SPI_WaitForUndocumentedTxFifoStatusBit waits on
+	if ((SPI0->IF & 0x20) == 0 || ++gDrainPolls > ST7565_DRAIN_POLLS)
+	{
+		gDrainPolls = 0;
+		return false;
+	}
+	return true;
+}
+
+static void ST7565_StartLine(void)
+{
+	unsigned int i;
+
+	// round robin from the line after the last one, so a screen blitted
+	// again before it was finished can't starve the bottom lines
+	for (i = 0; i <= ST7565_LINES; i++)
+	{
+		gLine = (gLine + 1) % (ST7565_LINES + 1);
+		if (gPendingLines & (1u << gLine))
+			break;
+	}
+
+	gPendingLines &= ~(1u << gLine);
+
+	if (gLine == ST7565_STATUS_LINE)
+	{
+		gColumn     = 0;
+		gLastColumn = ARRAY_SIZE(gStatusLine) - 1;
+	}
+	else
+	{	// take the span now, anything drawn from here on marks the line again
+		gColumn     = gDirtyFirst[gLine];
+		gLastColumn = gDirtyLast[gLine];
+		gDirtyFirst[gLine] = 0xFF;
+		gDirtyLast[gLine]  = 0x00;
+		if (gColumn > gLastColumn)
+			return;
+	}
+
+	SPI_ToggleMasterMode(&SPI0->CR, false);
+
+	// display page 0 is the status line, gFrameBuffer starts at page 1
+	GPIO_ClearBit(&GPIOB->DATA, GPIOB_PIN_ST7565_A0);
+	while ((SPI0->FIFOST & SPI_FIFOST_TFF_MASK) != SPI_FIFOST_TFF_BITS_NOT_FULL) {}
+	SPI0->WDR = 0x40;
+	while ((SPI0->FIFOST & SPI_FIFOST_TFF_MASK) != SPI_FIFOST_TFF_BITS_NOT_FULL) {}
+	SPI0->WDR = ((gLine + 1) % (ST7565_LINES + 1)) + 176;
+	while ((SPI0->FIFOST & SPI_FIFOST_TFF_MASK) != SPI_FIFOST_TFF_BITS_NOT_FULL) {}
+	SPI0->WDR = (((gColumn + 4) >> 4) & 0x0F) | 0x10;
+	while ((SPI0->FIFOST & SPI_FIFOST_TFF_MASK) != SPI_FIFOST_TFF_BITS_NOT_FULL) {}
+	SPI0->WDR = ((gColumn + 4) >> 0) & 0x0F;
+
+	gStep = ST7565_STEP_ADDRESS;
+}
+
+bool ST7565_Pump(void)
+{
+	while (1)
+	{
+		switch (gStep)
+		{
+			case ST7565_STEP_IDLE:
+				if (gPendingLines == 0)
+					return true;
+				ST7565_StartLine();
+				break;
+
+			case ST7565_STEP_ADDRESS:
+				// A0 may only change once the commands have left
+				if (ST7565_TxDraining())
+					return false;
+				GPIO_SetBit(&GPIOB->DATA, GPIOB_PIN_ST7565_A0);
+				gStep = ST7565_STEP_DATA;
+				break;
+
+			case ST7565_STEP_DATA:
+			{
+				const uint8_t *pLine = (gLine == ST7565_STATUS_LINE) ? gStatusLine : gFrameBuffer[gLine];
+
+				for (; gColumn <= gLastColumn; gColumn++)
+				{
+					if ((SPI0->FIFOST & SPI_FIFOST_TFF_MASK) != SPI_FIFOST_TFF_BITS_NOT_FULL)
+						return false;
+					SPI0->WDR = pLine[gColumn];
+				}
+				gStep = ST7565_STEP_END;
+				break;
+			}
+
+			case ST7565_STEP_END:
+				if (ST7565_TxDraining())
+					return false;
+				SPI_ToggleMasterMode(&SPI0->CR, true);
+				gStep = ST7565_STEP_IDLE;
+				break;
+		}
+	}
+}
+
+void ST7565_Flush(void)
+{
+	while (!ST7565_Pump()) {}
+}
+
 void ST7565_DrawLine(const unsigned int Column, const unsigned int Line, const unsigned int Size, const uint8_t *pBitmap)
 {
 	unsigned int i;
 
+	ST7565_Flush();
+
 	SPI_ToggleMasterMode(&SPI0->CR, false);
 
 	ST7565_SelectColumnAndLine(Column + 4U, Line);
@@ -65,63 +200,45 @@ void ST7565_DrawLine(const unsigned int Column, const unsigned int Line, const u
 
 void ST7565_BlitFullScreen(void)
 {
-	unsigned int Line;
+	memset(gDirtyFirst, 0x00, sizeof(gDirtyFirst));
+	memset(gDirtyLast,  LCD_WIDTH - 1, sizeof(gDirtyLast));
 
-	SPI_ToggleMasterMode(&SPI0->CR, false);
+	gPendingLines |= (1u << ST7565_LINES) - 1;
+}
 
-	ST7565_WriteByte(0x40);
+void ST7565_MarkDirty(const unsigned int Line, const unsigned int Column, const unsigned int Size)
+{
+	if (Line >= ARRAY_SIZE(gFrameBuffer) || Column >= LCD_WIDTH || Size == 0)
+		return;
 
-	for (Line = 0; Line < ARRAY_SIZE(gFrameBuffer); Line++)
-	{
-		unsigned int Column;
-		ST7565_SelectColumnAndLine(4, Line + 1);
-		GPIO_SetBit(&GPIOB->DATA, GPIOB_PIN_ST7565_A0);
-		for (Column = 0; Column < ARRAY_SIZE(gFrameBuffer[0]); Column++)
-		{
-			while ((SPI0->FIFOST & SPI_FIFOST_TFF_MASK) != SPI_FIFOST_TFF_BITS_NOT_FULL) {}
-			SPI0->WDR = gFrameBuffer[Line][Column];
-		}
-		SPI_WaitForUndocumentedTxFifoStatusBit();
-	}
+	const unsigned int Last = MIN(Column + Size - 1, LCD_WIDTH - 1u);
 
-	#if 0
-		// whats the delay for I wonder, it holds things up :(
-		SYSTEM_DelayMs(20);
-	#else
-//		SYSTEM_DelayMs(1);
-	#endif
+	if (gDirtyFirst[Line] > Column)
+		gDirtyFirst[Line] = Column;
+	if (gDirtyLast[Line] < Last)
+		gDirtyLast[Line] = Last;
+}
 
-	SPI_ToggleMasterMode(&SPI0->CR, true);
+void ST7565_BlitDirty(void)
+{
+	unsigned int Line;
+
+	for (Line = 0; Line < ST7565_LINES; Line++)
+		if (gDirtyFirst[Line] <= gDirtyLast[Line])
+			gPendingLines |= 1u << Line;
 }
 
 void ST7565_BlitStatusLine(void)
 {	// the top small text line on the display
-
-	unsigned int i;
-
-	SPI_ToggleMasterMode(&SPI0->CR, false);
-
-	ST7565_WriteByte(0x40);    // start line ?
-
-	ST7565_SelectColumnAndLine(4, 0);
-
-	GPIO_SetBit(&GPIOB->DATA, GPIOB_PIN_ST7565_A0);
-
-	for (i = 0; i < ARRAY_SIZE(gStatusLine); i++)
-	{
-		while ((SPI0->FIFOST & SPI_FIFOST_TFF_MASK) != SPI_FIFOST_TFF_BITS_NOT_FULL) {}
-		SPI0->WDR = gStatusLine[i];
-	}
-
-	SPI_WaitForUndocumentedTxFifoStatusBit();
-
-	SPI_ToggleMasterMode(&SPI0->CR, true);
+	gPendingLines |= 1u << ST7565_STATUS_LINE;
 }
 
 void ST7565_FillScreen(uint8_t Value)
 {
 	unsigned int i;
 
+	ST7565_Flush();
+
 	// reset some of the displays settings to try and overcome the radios hardware problem - RF corrupting the display
 	ST7565_Init(false);
 	
@@ -210,6 +327,8 @@ uint8_t cmds[] = {
 
 void ST7565_Init(const bool full)
 {
+	ST7565_Flush();
+
 	if (full) {
 		SPI0_Init();
 		ST7565_HardwareReset();
@@ -246,6 +365,7 @@ void ST7565_Init(const bool full)
 
 void ST7565_FixInterfGlitch(void)
 {
+	ST7565_Flush();
 	SPI_ToggleMasterMode(&SPI0->CR, false);
 	for(uint8_t i = 0; i < ARRAY_SIZE(cmds); i++)
 		ST7565_WriteByte(cmds[i]);
@@ -30,8 +30,17 @@ extern uint8_t gStatusLine[128];
 extern uint8_t gFrameBuffer[7][128];
 
 void ST7565_DrawLine(const unsigned int Column, const unsigned int Line, const unsigned int Size, const uint8_t *pBitmap);
+// the blits only queue lines, ST7565_Pump sends them
 void ST7565_BlitFullScreen(void);
+// remember that [Size] columns of gFrameBuffer[Line] changed since the last blit
+void ST7565_MarkDirty(const unsigned int Line, const unsigned int Column, const unsigned int Size);
+// send only the changed spans of gFrameBuffer
+void ST7565_BlitDirty(void);
 void ST7565_BlitStatusLine(void);
+// fill the SPI FIFO with queued lines without waiting on it, true once everything went out
+bool ST7565_Pump(void);
+// send all queued lines before returning
+void ST7565_Flush(void);
 void ST7565_FillScreen(uint8_t Value);
 void ST7565_Init(const bool full);
 void ST7565_FixInterfGlitch(void);
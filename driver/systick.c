@@ -46,3 +46,16 @@ void SYSTICK_DelayUs(uint32_t Delay)
 	} while (i < ticks);
 }
 
+// milliseconds since SYSTICK_Init, the 10ms tick count plus how far into the current tick we are
+uint32_t SYSTICK_GetMs(void)
+{
+	uint32_t Ticks;
+	uint32_t Value;
+	do {
+		Ticks = gGlobalSysTickCounter;
+		Value = SysTick->VAL;
+	} while (Ticks != gGlobalSysTickCounter);
+
+	return (Ticks * 10) + (SysTick->LOAD - Value) / (gTickMultiplier * 1000);
+}
+
@@ -22,8 +22,12 @@
 
 #include <stdint.h>
 
+// bumped by SystickHandler every 10ms
+extern volatile uint32_t gGlobalSysTickCounter;
+
 void SYSTICK_Init(void);
 void SYSTICK_DelayUs(uint32_t Delay);
+uint32_t SYSTICK_GetMs(void);
 
 #endif
 
@@ -102,6 +102,18 @@ void UART_Send(const void *pBuffer, uint32_t Size)
 	}
 }
 
+uint32_t UART_SendSome(const void *pBuffer, uint32_t Size)
+{
+	const uint8_t *pData = (const uint8_t *)pBuffer;
+	uint32_t i;
+
+	for (i = 0; i < Size && (UART1->IF & UART_IF_TXFIFO_FULL_MASK) == UART_IF_TXFIFO_FULL_BITS_NOT_SET; i++) {
+		UART1->TDR = pData[i];
+	}
+
+	return i;
+}
+
 void UART_LogSend(const void *pBuffer, uint32_t Size)
 {
 	if (UART_IsLogEnabled) {
@@ -27,6 +27,8 @@ extern uint8_t UART_DMA_Buffer[256];
 
 void UART_Init(void);
 void UART_Send(const void *pBuffer, uint32_t Size);
+// only what fits in the TX FIFO right now, returns how much that was
+uint32_t UART_SendSome(const void *pBuffer, uint32_t Size);
 void UART_LogSend(const void *pBuffer, uint32_t Size);
 #ifdef ENABLE_MESSENGER_UART
     void UART_printf(const char *str, ...);
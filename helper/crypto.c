@@ -39,46 +39,121 @@ static const uint8_t displaySalt[32] = {
 	0x65, 0xB9, 0x69, 0x22, 0xB3, 0x6F, 0xB4, 0x59, 0xC7, 0x90, 0x10, 0x70, 0xFA, 0x51, 0xA0, 0x19
 };
 
-// Used for both encryption and decryption
-void CRYPTO_Crypt(void *input, int input_len, void *output, void *nonce, const void *key, int key_len)
+// key schedule for gEncryptionKey, only set up again when the key changes
+static struct chacha_ctx encryptionCtx;
+
+void CRYPTO_SetKey(const void *key, int key_len)
 {
-	struct chacha_ctx ctx;
+	memset(&encryptionCtx, 0, sizeof(encryptionCtx));
+	chacha_keysetup(&encryptionCtx, key, key_len);
+}
 
-	unsigned char keystream[CHACHA_BLOCKLEN];
+// Used for both encryption and decryption, any length
+void CRYPTO_Crypt(const void *input, int input_len, void *output, const void *nonce)
+{
+	struct chacha_ctx ctx = encryptionCtx;
+	unsigned char     block[CHACHA_BLOCKLEN];
+	const int         half  = CHACHA_BLOCKLEN / 2;
+	const int         first = input_len < half ? input_len : half;
 
-	memset(&ctx, 0, sizeof(ctx));
-	chacha_keysetup(&ctx, key, key_len);
+	if (input_len <= 0)
+		return;
 
-	// init keystream and generate key
-	memset(keystream, 0, sizeof(keystream));
 	chacha_ivsetup(&ctx, nonce, NULL);
-	chacha_encrypt_bytes(&ctx, keystream, keystream,sizeof(keystream));
 
-	// crypt data, only works for input_len <= 32
-	for (uint8_t i = 0; i < input_len; i++) {
-		((unsigned char *)output)[i] =
-			((unsigned char *)input)[i] ^ keystream[32 + i];
-	}
+	// messages always started 32 bytes into the first block, keep it that way
+	// so they still decrypt, the rest follows on from the second block
+	memset(block, 0, half);
+	memcpy(block + half, input, first);
+	chacha_encrypt_bytes(&ctx, block, block, half + first);
+	memcpy(output, block + half, first);
+
+	if (input_len > first)
+		chacha_encrypt_bytes(&ctx, (const unsigned char *)input + first, (unsigned char *)output + first, input_len - first);
 }
 
-// Generate random byte
-uint8_t CRYPTO_RandomByte()
+// Random numbers come out of a ChaCha keystream. Radio noise is stirred into
+// a small pool every tick and the pool goes into the key each time a block is
+// made. Half of every block becomes the next key, so nothing handed out before
+// can be worked back from the state, the other half is handed out.
+#define RANDOM_SEED_SAMPLES   128 // stirred in before the output is trusted, about 1.3s after power on
+#define RANDOM_RESEED_SAMPLES 32  // between reseeds done in the background
+
+static uint8_t  randomPool[32];
+static uint8_t  randomPoolPos;
+static uint8_t  randomKey[32];
+static uint8_t  randomOut[CHACHA_BLOCKLEN - sizeof(randomKey)];
+static uint8_t  randomOutAvail;
+static uint8_t  randomFresh;   // samples since the last reseed
+static uint16_t randomSamples; // since power on, stops counting at RANDOM_SEED_SAMPLES
+
+static void CRYPTO_Stir(void)
 {
-	uint8_t randByte = 0x00;
-	uint8_t noise;
-	for(uint8_t i = 0; i < 8; i++) {
-		noise = BK4819_ReadRegister(BK4819_REG_65) & 0x007F;
-		randByte |= (noise & 0x01)<< i;
-		SYSTICK_DelayUs(979);
-	}
-	return randByte;
+	// only the low bits of either change from one read to the next,
+	// the rotation spreads them over the byte before the next round
+	const uint8_t noise = BK4819_ReadRegister(BK4819_REG_65) & 0x007F;
+	const uint8_t rssi  = BK4819_GetRSSI();
+	uint8_t       pool  = randomPool[randomPoolPos];
+
+	randomPool[randomPoolPos] = (uint8_t)((pool << 3) | (pool >> 5)) ^ noise ^ (uint8_t)(rssi << 5);
+	randomPoolPos = (randomPoolPos + 1) % sizeof(randomPool);
+
+	if (randomSamples < RANDOM_SEED_SAMPLES)
+		randomSamples++;
 }
 
-// Generate random number from the radio noise
+static void CRYPTO_Reseed(void)
+{
+	// the key is never used twice, so a fixed nonce is fine
+	static const uint8_t nonce[12];
+	struct chacha_ctx    ctx;
+	unsigned char        block[CHACHA_BLOCKLEN];
+
+	for (uint8_t i = 0; i < sizeof(randomKey); i++)
+		randomKey[i] ^= randomPool[i];
+
+	memset(block, 0, sizeof(block));
+	chacha_keysetup(&ctx, randomKey, 256);
+	chacha_ivsetup(&ctx, nonce, NULL);
+	chacha_encrypt_bytes(&ctx, block, block, sizeof(block));
+
+	memcpy(randomKey, block, sizeof(randomKey));
+	memcpy(randomOut, block + sizeof(randomKey), sizeof(randomOut));
+	randomOutAvail = sizeof(randomOut);
+	randomFresh    = 0;
+
+	memset(&ctx, 0, sizeof(ctx));
+	memset(block, 0, sizeof(block));
+}
+
+void CRYPTO_TimeSlice10ms(void)
+{
+	CRYPTO_Stir();
+
+	if (++randomFresh >= RANDOM_RESEED_SAMPLES)
+		CRYPTO_Reseed();
+}
+
+// Generate random number from the pool, never waits on the radio
+// unless asked right after power on
 void CRYPTO_Random(void *output, int len)
 {
-	for (uint8_t i = 0; i < len; i++) {
-		((unsigned char *)output)[i] = CRYPTO_RandomByte();
+	if (randomSamples < RANDOM_SEED_SAMPLES) {
+		while (randomSamples < RANDOM_SEED_SAMPLES) {
+			CRYPTO_Stir();
+			SYSTICK_DelayUs(979);
+		}
+		CRYPTO_Reseed();
+	}
+
+	for (int i = 0; i < len; i++) {
+		if (randomOutAvail == 0)
+			CRYPTO_Reseed();
+
+		// bytes handed out don't stay behind in RAM
+		randomOutAvail--;
+		((unsigned char *)output)[i] = randomOut[randomOutAvail];
+		randomOut[randomOutAvail]    = 0;
 	}
 }
 
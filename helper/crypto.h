@@ -25,10 +25,13 @@ union eight_bytes {
   uint8_t b8[sizeof(uint64_t)];
 };
 
+// sets up the key CRYPTO_Crypt uses, key_len in bits
+void CRYPTO_SetKey(const void *key, int key_len);
 // Used for both encryption and decryption
-void CRYPTO_Crypt(void *input, int input_len, void *output, void *nonce, const void *key, int key_len);
+void CRYPTO_Crypt(const void *input, int input_len, void *output, const void *nonce);
 void CRYPTO_Random(void *output, int len);
-uint8_t CRYPTO_RandomByte();
+// stirs radio noise into the pool CRYPTO_Random draws from
+void CRYPTO_TimeSlice10ms(void);
 void CRYPTO_DisplayHash(void *input, void *output, int input_len);
 void CRYPTO_Generate256BitKey(void *input, void *output, int input_len);
 void CRYPTO_HashSalted(const void *input, void *output, const void *salt, int input_len, int salt_len);
\ No newline at end of file
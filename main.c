@@ -21,6 +21,9 @@
 #include <stdio.h>     // NULL
 
 #include "app/app.h"
+#ifdef ENABLE_ACTIVITY_LOG
+	#include "app/activity.h"
+#endif
 #include "app/dtmf.h"
 #include "audio.h"
 #include "bsp/dp32g030/gpio.h"
@@ -29,6 +32,7 @@
 #include "driver/backlight.h"
 #include "driver/bk4819.h"
 #include "driver/gpio.h"
+#include "driver/st7565.h"
 #include "driver/system.h"
 #include "driver/systick.h"
 #include "driver/uart.h"
@@ -44,12 +48,51 @@
 #ifdef ENABLE_MESSENGER
 	#include "app/messenger.h"
 #endif
+#ifdef ENABLE_UART
+	#include "external/printf/printf.h"
+#endif
 
 void _putchar(char c)
 {
 	UART_Send((uint8_t *)&c, 1);
 }
 
+#ifdef ENABLE_UART
+	// where the time goes between power on and the main loop
+	enum {
+		BOOT_PHASE_HARDWARE = 0,
+		BOOT_PHASE_EEPROM,
+		BOOT_PHASE_BK4819,
+		BOOT_PHASE_RADIO,
+		BOOT_PHASE_BATTERY,
+		BOOT_PHASE_UI,
+		BOOT_PHASE_COUNT
+	};
+
+	static uint32_t gBootPhaseEnd[BOOT_PHASE_COUNT];
+
+	#define BOOT_PHASE_DONE(Phase) gBootPhaseEnd[Phase] = SYSTICK_GetMs()
+
+	static void BOOT_ReportTimes(void)
+	{
+		static const char *const Names[BOOT_PHASE_COUNT] = {"hw", "eeprom", "bk4819", "radio", "battery", "ui"};
+		char         String[24];
+		uint32_t     Start = 0;
+		unsigned int i;
+
+		UART_Send("BOOT ms", 7);
+		for (i = 0; i < BOOT_PHASE_COUNT; i++)
+		{
+			const int Len = sprintf(String, " %s=%lu", Names[i], (unsigned long)(gBootPhaseEnd[i] - Start));
+			UART_Send(String, Len);
+			Start = gBootPhaseEnd[i];
+		}
+		UART_Send(String, sprintf(String, " total=%lu\r\n", (unsigned long)Start));
+	}
+#else
+	#define BOOT_PHASE_DONE(Phase)
+#endif
+
 void Main(void)
 {
 	unsigned int i;
@@ -71,6 +114,8 @@ void Main(void)
 	BOARD_Init();
 	UART_Init();
 
+	BOOT_PHASE_DONE(BOOT_PHASE_HARDWARE);
+
 	boot_counter_10ms = 250;   // 2.5 sec
 
 	UART_Send(UART_Version, strlen(UART_Version));
@@ -86,8 +131,16 @@ void Main(void)
 
 	BOARD_EEPROM_Init();
 
+	#ifdef ENABLE_ACTIVITY_LOG
+		ACTIVITY_Init();
+	#endif
+
+	BOOT_PHASE_DONE(BOOT_PHASE_EEPROM);
+
 	BK4819_Init();
 
+	BOOT_PHASE_DONE(BOOT_PHASE_BK4819);
+
 	BOARD_EEPROM_LoadCalibration();
 
 	RADIO_ConfigureChannel(0, VFO_CONFIGURE_RELOAD);
@@ -100,11 +153,15 @@ void Main(void)
 	BK4819_InitAGC(gEeprom.RX_AGC, gTxVfo->Modulation);
 	BK4819_SetAGC(gEeprom.RX_AGC!=RX_AGC_OFF);
 
+	BOOT_PHASE_DONE(BOOT_PHASE_RADIO);
+
 	for (i = 0; i < ARRAY_SIZE(gBatteryVoltages); i++)
 		BOARD_ADC_GetBatteryInfo(&gBatteryVoltages[i]);
 
 	BATTERY_GetReadings(false);
 
+	BOOT_PHASE_DONE(BOOT_PHASE_BATTERY);
+
 	#ifdef ENABLE_MESSENGER
 		MSG_Init();
 	#endif
@@ -213,10 +270,18 @@ void Main(void)
 		// ******************
 	}
 
+	BOOT_PHASE_DONE(BOOT_PHASE_UI);
+
+	#ifdef ENABLE_UART
+		BOOT_ReportTimes();
+	#endif
+
 	while (1)
 	{
 		APP_Update();
 
+		ST7565_Pump();
+
 		if (gNextTimeslice)
 		{
 			APP_TimeSlice10ms();
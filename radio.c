@@ -25,6 +25,9 @@
 #endif
 #include "audio.h"
 #include "bsp/dp32g030/gpio.h"
+#ifdef ENABLE_CHANNEL_CACHE
+	#include "channels.h"
+#endif
 #include "dcs.h"
 #include "driver/bk4819.h"
 #include "driver/eeprom.h"
@@ -99,7 +102,12 @@ bool RADIO_CheckValidChannel(uint16_t Channel, bool bCheckScanList, uint8_t VFO)
 uint8_t RADIO_FindNextChannel(uint8_t Channel, int8_t Direction, bool bCheckScanList, uint8_t VFO)
 {
 	unsigned int i;
-		
+
+	#ifdef ENABLE_CHANNEL_CACHE
+		if (Direction == 1 || Direction == -1)
+			return CHANNELS_Step(Channel, Direction, (!bCheckScanList || VFO > 1) ? CHANNEL_LIST_ALL : CHANNEL_LIST_1 + VFO);
+	#endif
+
 	for (i = 0; IS_MR_CHANNEL(i); i++)
 	{
 		if (Channel == 0xFF)
@@ -233,9 +241,28 @@ void RADIO_ConfigureChannel(const unsigned int VFO, const unsigned int configure
 		uint8_t tmp;
 		uint8_t data[8];
 
+		struct {
+			uint32_t Frequency;
+			uint32_t Offset;
+		} __attribute__((packed)) info;
+
 		// ***************
 
-		EEPROM_ReadBuffer(base + 8, data, sizeof(data));
+		#ifdef ENABLE_CHANNEL_CACHE
+			if (IS_MR_CHANNEL(channel))
+			{
+				const CHANNEL_Record_t *pRecord = CHANNELS_Get(channel);
+
+				memcpy(data, pRecord->Data, sizeof(data));
+				info.Frequency = pRecord->Frequency;
+				info.Offset    = pRecord->Offset;
+			}
+			else
+		#endif
+		{
+			EEPROM_ReadBuffer(base + 8, data, sizeof(data));
+			EEPROM_ReadBuffer(base, &info, sizeof(info));
+		}
 
 		tmp = data[3] & 0x0F;
 		if (tmp > TX_OFFSET_FREQUENCY_DIRECTION_SUB)
@@ -339,11 +366,6 @@ void RADIO_ConfigureChannel(const unsigned int VFO, const unsigned int configure
 
 		// ***************
 
-		struct {
-			uint32_t Frequency;
-			uint32_t Offset;
-		} __attribute__((packed)) info;
-		EEPROM_ReadBuffer(base, &info, sizeof(info));
 		if(info.Frequency==0xFFFFFFFF)
 			pVfo->freq_config_RX.Frequency = frequencyBandTable[band].lower;
 		else
@@ -574,6 +596,8 @@ void RADIO_SelectVfos(void)
 
 void RADIO_SetupRegisters(bool switchToForeground)
 {
+	const uint32_t BusWrites = gBK4819_BusWrites;
+
 	AUDIO_AudioPathOff();
 
 	gEnableSpeaker = false;
@@ -763,12 +787,52 @@ void RADIO_SetupRegisters(bool switchToForeground)
 
 	BK4819_WriteRegister(BK4819_REG_3F, InterruptMask);
 
+	gBK4819_OperationWrites[BK4819_OP_SETUP] = gBK4819_BusWrites - BusWrites;
+
 	FUNCTION_Init();
 
 	if (switchToForeground)
 		FUNCTION_Select(FUNCTION_FOREGROUND);
 }
 
+// Stepping a scan only moves the frequency, so everything RADIO_SetupRegisters
+// did stays as it is apart from the PLL, the LNA path and across bands the squelch
+void RADIO_Retune(bool bBandChanged)
+{
+	#ifdef ENABLE_NOAA
+		const uint32_t Frequency = gRxVfo->pRX->Frequency;
+	#else
+		const uint32_t Frequency = gRxVfo->pRX->Frequency + gEeprom.RX_OFFSET;
+	#endif
+
+	if (bBandChanged)
+	{
+		RADIO_ConfigureSquelchAndOutputPower(gRxVfo);
+
+		BK4819_SetupSquelch(
+			gRxVfo->SquelchOpenRSSIThresh,    gRxVfo->SquelchCloseRSSIThresh,
+			gRxVfo->SquelchOpenNoiseThresh,   gRxVfo->SquelchCloseNoiseThresh,
+			gRxVfo->SquelchCloseGlitchThresh, gRxVfo->SquelchOpenGlitchThresh);
+	}
+
+	BK4819_SetFrequency(Frequency);
+	BK4819_PickRXFilterPathBasedOnFrequency(Frequency);
+
+	// restart the VCO calibration so the PLL doesn't take its time to catch up
+	const uint16_t Reg30 = BK4819_ReadRegister(BK4819_REG_30);
+	BK4819_WriteRegister(BK4819_REG_30, 0);
+	BK4819_WriteRegister(BK4819_REG_30, Reg30);
+
+	// whatever was pending belongs to the old frequency
+	while (BK4819_ReadRegister(BK4819_REG_0C) & 1u)
+	{
+		BK4819_WriteRegister(BK4819_REG_02, 0);
+		SYSTEM_DelayMs(1);
+	}
+
+	FUNCTION_Init();
+}
+
 #ifdef ENABLE_NOAA
 	void RADIO_ConfigureNOAA(void)
 	{
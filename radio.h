@@ -166,6 +166,7 @@ void       RADIO_ConfigureSquelchAndOutputPower(VFO_Info_t *pInfo);
 void       RADIO_ApplyTxOffset(VFO_Info_t *pInfo);
 void       RADIO_SelectVfos(void);
 void       RADIO_SetupRegisters(bool bSwitchToFunction0);
+void       RADIO_Retune(bool bBandChanged);
 #ifdef ENABLE_NOAA
 	void   RADIO_ConfigureNOAA(void);
 #endif
@@ -22,6 +22,9 @@
 #ifdef ENABLE_FMRADIO
 	#include "app/fm.h"
 #endif
+#ifdef ENABLE_CHANNEL_CACHE
+	#include "channels.h"
+#endif
 #include "driver/eeprom.h"
 #include "driver/uart.h"
 #include "driver/bk4819.h"
@@ -35,6 +38,10 @@
 
 EEPROM_Config_t gEeprom;
 
+// EEPROM writes are only queued here, APP_TimeSlice500ms burns them in.
+// Whoever needs them on the chip before going on, a reset for one,
+// calls EEPROM_Flush() itself.
+
 void SETTINGS_SaveVfoIndices(void)
 {
 	uint8_t State[8];
@@ -262,6 +269,10 @@ void SETTINGS_SaveChannel(uint8_t Channel, uint8_t VFO, const VFO_Info_t *pVFO,
 						#endif
 					}
 				#endif
+
+				#ifdef ENABLE_CHANNEL_CACHE
+					CHANNELS_Update(Channel);
+				#endif
 			}
 		}
 	}
@@ -285,6 +296,10 @@ void SETTINGS_SaveChannelName(uint8_t channel, const char * name)
 	memcpy(buf, name, MIN(strlen(name),10u));
 	EEPROM_WriteBuffer(0x0F50 + offset, buf, true);
 	EEPROM_WriteBuffer(0x0F58 + offset, buf + 8, true);
+
+	#ifdef ENABLE_CHANNEL_CACHE
+		CHANNELS_Update(channel);
+	#endif
 }
 
 #ifdef ENABLE_ENCRYPTION
@@ -330,8 +345,6 @@ void SETTINGS_SavePath_2() {
 
 void SETTINGS_FetchChannelName(char *s, const int channel)
 {
-	int i;
-
 	if (s == NULL)
 		return;
 
@@ -344,8 +357,19 @@ void SETTINGS_FetchChannelName(char *s, const int channel)
 		return;
 
 
-	EEPROM_ReadBuffer(0x0F50 + (channel * 16), s + 0, 8);
-	EEPROM_ReadBuffer(0x0F58 + (channel * 16), s + 8, 2);
+	#ifdef ENABLE_CHANNEL_CACHE
+		SETTINGS_CopyChannelName(s, CHANNELS_Get(channel)->Name);
+	#else
+		EEPROM_ReadBuffer(0x0F50 + (channel * 16), s, 10);
+		SETTINGS_CopyChannelName(s, s);
+	#endif
+}
+
+void SETTINGS_CopyChannelName(char *s, const void *pRaw)
+{	// 's' needs room for 11 chars, 'pRaw' is the 10 byte name as stored
+	int i;
+
+	memmove(s, pRaw, 10);
 
 	for (i = 0; i < 10; i++)
 		if (s[i] < 32 || s[i] > 127)
@@ -394,6 +418,11 @@ void SETTINGS_UpdateChannel(uint8_t channel, const VFO_Info_t *pVFO, bool keep)
 				SETTINGS_SaveChannelName(channel, "");
 			}
 		}
+
+		#ifdef ENABLE_CHANNEL_CACHE
+			// scan list links follow the attributes
+			CHANNELS_Update(channel);
+		#endif
 	}
 }
 
@@ -0,0 +1,71 @@
+// Builds frames with AX25_insert_paths and parses them back. The
+// digipeaters have to sit between the source and the control field, only
+// the last address may carry the end bit and no digipeater may look
+// repeated before it has been.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "app/ax25.h"
+
+static unsigned int failures;
+
+// the bundled printf wants this even though only vsnprintf is used
+void _putchar(char c) {
+    (void)c;
+}
+
+static void check(int ok, const char * what, uint8_t paths) {
+    if(!ok) {
+        printf("ax25: %s failed, %u paths\n", what, paths);
+        failures++;
+    }
+}
+
+static void check_paths(uint8_t paths) {
+    static const char * path_strings[] = { "WIDE1-1", "WIDE2-2", "RELAY", "WIDE3-3", "TEST-15", "A-1", "WIDE7-7", "WIDE2" };
+    static const uint8_t ssids[] = { 1, 2, 0, 3, 15, 1, 7, 0 };
+    AX25UIFrame frame;
+    AX25View view;
+    char name[AX25_ADDRESS_STRING_SIZE + 1];
+
+    memset(&frame, 0, sizeof(frame));
+    AX25_insert_destination(&frame, "APRS", 0);
+    AX25_insert_source(&frame, "N0CALL", 7);
+    if(paths > 0)
+        AX25_insert_paths(&frame, path_strings, paths);
+    AX25_insert_info(&frame, ":%-9s:%s", "EA4IAU", "hello");
+
+    check(AX25_parse(&view, frame.raw_buffer, frame.len), "parse", paths);
+    check(view.addresses == 2 + paths, "address count", paths);
+    check(view.control == (2 + paths) * CALLSIGN_SIZE, "control after the addresses", paths);
+    check((uint8_t)frame.raw_buffer[view.control] == AX25_CONTROL_UI, "control", paths);
+    check((uint8_t)frame.raw_buffer[view.control + 1] == AX25_PID_NO_LAYER3, "pid", paths);
+    check(AX25_info_len(&view) == 16 && memcmp(AX25_info(&view), ":EA4IAU   :hello", 16) == 0, "info", paths);
+
+    AX25_address_to_string(&view, AX25_SOURCE, name);
+    check(strcmp(name, "N0CALL-7") == 0, "source", paths);
+
+    for(uint8_t i = 0; i < paths; i++) {
+        const uint8_t index = AX25_FIRST_DIGI + i;
+
+        check(!AX25_repeated(&view, index), "H bit clear", paths);
+        check(AX25_ssid(&view, index) == ssids[i], "digi ssid", paths);
+    }
+    check(AX25_next_digi(&view) == (paths ? AX25_FIRST_DIGI : 0), "next digi", paths);
+
+    // end bit on the last address only
+    for(uint8_t i = 0; i < view.addresses; i++) {
+        const uint8_t last = AX25_address(&view, i)[CALLSIGN_SIZE - 1] & 0x01;
+        check(last == (i == view.addresses - 1), "end bit", paths);
+    }
+}
+
+int main(void) {
+    for(uint8_t paths = 0; paths <= MAX_DIGIS; paths++)
+        check_paths(paths);
+
+    printf("ax25: %u failures\n", failures);
+
+    return failures != 0;
+}
@@ -0,0 +1,195 @@
+// Checks CRYPTO_Crypt against the ChaCha20 test vectors and against the
+// original single block version, which is kept here as the reference, then
+// times CRYPTO_SetKey and CRYPTO_Crypt.
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "external/chacha/chacha.h"
+#include "helper/crypto.h"
+#include "driver/bk4819.h"
+#include "driver/systick.h"
+
+static unsigned int gFailures;
+
+// the random pool reads the radio, none of that is exercised here
+uint16_t BK4819_ReadRegister(BK4819_REGISTER_t Register)
+{
+	(void)Register;
+	return 0;
+}
+
+uint16_t BK4819_GetRSSI(void)
+{
+	return 0;
+}
+
+void SYSTICK_DelayUs(uint32_t Delay)
+{
+	(void)Delay;
+}
+
+// 256 bit key, 32 bit counter from 0, 96 bit nonce, 20 rounds. The nonce
+// is the first 12 bytes of the one the packets carry
+static const struct {
+	uint8_t Key[32];
+	uint8_t Nonce[12];
+	uint8_t Stream[64];
+} Vectors[] = {
+	{
+		{ 0 },
+		{ 0 },
+		{
+			0x76, 0xB8, 0xE0, 0xAD, 0xA0, 0xF1, 0x3D, 0x90, 0x40, 0x5D, 0x6A, 0xE5, 0x53, 0x86, 0xBD, 0x28,
+			0xBD, 0xD2, 0x19, 0xB8, 0xA0, 0x8D, 0xED, 0x1A, 0xA8, 0x36, 0xEF, 0xCC, 0x8B, 0x77, 0x0D, 0xC7,
+			0xDA, 0x41, 0x59, 0x7C, 0x51, 0x57, 0x48, 0x8D, 0x77, 0x24, 0xE0, 0x3F, 0xB8, 0xD8, 0x4A, 0x37,
+			0x6A, 0x43, 0xB8, 0xF4, 0x15, 0x18, 0xA1, 0x1C, 0xC3, 0x87, 0xB6, 0x69, 0xB2, 0xEE, 0x65, 0x86
+		}
+	},
+	{
+		{ [31] = 0x01 },
+		{ 0 },
+		{
+			0x45, 0x40, 0xF0, 0x5A, 0x9F, 0x1F, 0xB2, 0x96, 0xD7, 0x73, 0x6E, 0x7B, 0x20, 0x8E, 0x3C, 0x96,
+			0xEB, 0x4F, 0xE1, 0x83, 0x46, 0x88, 0xD2, 0x60, 0x4F, 0x45, 0x09, 0x52, 0xED, 0x43, 0x2D, 0x41,
+			0xBB, 0xE2, 0xA0, 0xB6, 0xEA, 0x75, 0x66, 0xD2, 0xA5, 0xD1, 0xE7, 0xE2, 0x0D, 0x42, 0xAF, 0x2C,
+			0x53, 0xD7, 0x92, 0xB1, 0xC4, 0x3F, 0xEA, 0x81, 0x7E, 0x9A, 0xD2, 0x75, 0xAE, 0x54, 0x69, 0x63
+		}
+	},
+};
+
+// what CRYPTO_Crypt did before the key schedule was cached, up to 32 bytes
+static void REF_Crypt(const void *input, int input_len, void *output, const void *nonce, const void *key, int key_len)
+{
+	struct chacha_ctx ctx;
+	unsigned char     keystream[CHACHA_BLOCKLEN];
+
+	memset(&ctx, 0, sizeof(ctx));
+	chacha_keysetup(&ctx, key, key_len);
+
+	memset(keystream, 0, sizeof(keystream));
+	chacha_ivsetup(&ctx, nonce, NULL);
+	chacha_encrypt_bytes(&ctx, keystream, keystream, sizeof(keystream));
+
+	for (int i = 0; i < input_len; i++)
+		((unsigned char *)output)[i] = ((const unsigned char *)input)[i] ^ keystream[32 + i];
+}
+
+static void Check(int Ok, const char *What, int Length)
+{
+	if (!Ok) {
+		printf("crypto: %s failed, length %d\n", What, Length);
+		gFailures++;
+	}
+}
+
+static uint32_t Random(void)
+{
+	static uint32_t State = 0x12345678;
+
+	State ^= State << 13;
+	State ^= State >> 17;
+	State ^= State << 5;
+	return State;
+}
+
+static void RandomFill(uint8_t *pData, int Length)
+{
+	for (int i = 0; i < Length; i++)
+		pData[i] = Random();
+}
+
+static void CheckVectors(void)
+{
+	for (unsigned int i = 0; i < sizeof(Vectors) / sizeof(Vectors[0]); i++) {
+		uint8_t Zero[64] = { 0 };
+		uint8_t Out[64];
+
+		// CRYPTO_Crypt starts half way into the first block
+		CRYPTO_SetKey(Vectors[i].Key, 256);
+		CRYPTO_Crypt(Zero, 32, Out, Vectors[i].Nonce);
+		Check(memcmp(Out, Vectors[i].Stream + 32, 32) == 0, "test vector", 32);
+	}
+}
+
+static void CheckReference(void)
+{
+	uint8_t Key[32];
+	uint8_t Nonce[12];
+	uint8_t Plain[256];
+	uint8_t Cipher[256];
+	uint8_t Expected[256];
+	uint8_t Stream[256 + 32];
+
+	for (int n = 0; n < 2000; n++) {
+		const int Length = Random() % (sizeof(Plain) + 1);
+
+		RandomFill(Key, sizeof(Key));
+		RandomFill(Nonce, sizeof(Nonce));
+		RandomFill(Plain, sizeof(Plain));
+
+		CRYPTO_SetKey(Key, 256);
+		CRYPTO_Crypt(Plain, Length, Cipher, Nonce);
+
+		if (Length <= 32) {
+			REF_Crypt(Plain, Length, Expected, Nonce, Key, 256);
+		} else {
+			// past 32 bytes it is the keystream from offset 32 onwards
+			struct chacha_ctx ctx;
+
+			memset(&ctx, 0, sizeof(ctx));
+			memset(Stream, 0, sizeof(Stream));
+			chacha_keysetup(&ctx, Key, 256);
+			chacha_ivsetup(&ctx, Nonce, NULL);
+			chacha_encrypt_bytes(&ctx, Stream, Stream, 32 + Length);
+			for (int i = 0; i < Length; i++)
+				Expected[i] = Plain[i] ^ Stream[32 + i];
+		}
+		Check(memcmp(Cipher, Expected, Length) == 0, "reference", Length);
+
+		CRYPTO_Crypt(Cipher, Length, Cipher, Nonce);
+		Check(memcmp(Cipher, Plain, Length) == 0, "in place round trip", Length);
+	}
+}
+
+static void Benchmark(void)
+{
+	uint8_t         Key[32];
+	uint8_t         Nonce[12];
+	uint8_t         Data[128];
+	const int       Rounds = 200000;
+	struct timespec Start;
+	struct timespec End;
+
+	RandomFill(Key, sizeof(Key));
+	RandomFill(Nonce, sizeof(Nonce));
+	RandomFill(Data, sizeof(Data));
+
+	clock_gettime(CLOCK_MONOTONIC, &Start);
+	for (int i = 0; i < Rounds; i++)
+		CRYPTO_SetKey(Key, 256);
+	clock_gettime(CLOCK_MONOTONIC, &End);
+	printf("crypto: set key %.0f ns\n", ((End.tv_sec - Start.tv_sec) * 1e9 + (End.tv_nsec - Start.tv_nsec)) / Rounds);
+
+	for (int Length = 32; Length <= (int)sizeof(Data); Length *= 2) {
+		clock_gettime(CLOCK_MONOTONIC, &Start);
+		for (int i = 0; i < Rounds; i++)
+			CRYPTO_Crypt(Data, Length, Data, Nonce);
+		clock_gettime(CLOCK_MONOTONIC, &End);
+		printf("crypto: %3d bytes %.0f ns\n", Length, ((End.tv_sec - Start.tv_sec) * 1e9 + (End.tv_nsec - Start.tv_nsec)) / Rounds);
+	}
+}
+
+int main(void)
+{
+	CheckVectors();
+	CheckReference();
+	Benchmark();
+
+	printf("crypto: %u failures\n", gFailures);
+
+	return gFailures != 0;
+}
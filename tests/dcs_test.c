@@ -0,0 +1,150 @@
+// Checks the table driven DCS/CTCSS lookups in dcs.c against the original
+// brute force versions, which are kept here as the reference.
+
+#include <stdio.h>
+
+#include "dcs.h"
+
+#define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
+
+static unsigned int gFailures;
+
+static uint32_t REF_CalculateGolay(uint32_t CodeWord)
+{
+	unsigned int i;
+	uint32_t Word = CodeWord;
+	for (i = 0; i < 12; i++)
+	{
+		Word <<= 1;
+		if (Word & 0x1000)
+			Word ^= 0x08EA;
+	}
+	return CodeWord | ((Word & 0x0FFE) << 11);
+}
+
+// normal polarity, any rotation
+static uint8_t REF_GetCdcssCode(uint32_t Code)
+{
+	unsigned int i;
+	for (i = 0; i < 23; i++)
+	{
+		uint32_t Shift;
+
+		if (((Code >> 9) & 0x7U) == 4)
+		{
+			unsigned int j;
+			for (j = 0; j < ARRAY_SIZE(DCS_Options); j++)
+				if (DCS_Options[j] == (Code & 0x1FF))
+					if (REF_CalculateGolay(DCS_Options[j] + 0x800U) == Code)
+						return j;
+		}
+
+		Shift = Code >> 1;
+		if (Code & 1U)
+			Shift |= 0x400000U;
+		Code = Shift;
+	}
+
+	return 0xFF;
+}
+
+static uint8_t REF_GetCtcssCode(int Code)
+{
+	unsigned int i;
+	uint8_t      Result = 0xFF;
+	int          Smallest = ARRAY_SIZE(CTCSS_Options);
+
+	for (i = 0; i < ARRAY_SIZE(CTCSS_Options); i++)
+	{
+		int Delta = Code - CTCSS_Options[i];
+		if (Delta < 0)
+			Delta = -(Code - CTCSS_Options[i]);
+		if (Smallest > Delta)
+		{
+			Smallest = Delta;
+			Result   = i;
+		}
+	}
+
+	return Result;
+}
+
+// a normal reading wins, the inverted one is only looked at if there is none
+static void CheckCdcss(uint32_t Code)
+{
+	DCS_CodeType_t ExpectedType = CODE_TYPE_DIGITAL;
+	uint8_t        Expected     = REF_GetCdcssCode(Code);
+	DCS_CodeType_t Type;
+	uint8_t        Option;
+
+	if (Expected == 0xFF)
+	{
+		Expected     = REF_GetCdcssCode(Code ^ 0x7FFFFF);
+		ExpectedType = (Expected == 0xFF) ? CODE_TYPE_OFF : CODE_TYPE_REVERSE_DIGITAL;
+	}
+
+	Option = DCS_FindCdcssCode(Code, &Type);
+	if (Option != Expected || Type != ExpectedType)
+	{
+		if (gFailures++ < 10)
+			printf("DCS_FindCdcssCode(%06X) = %u/%d, expected %u/%d\n",
+				(unsigned int)Code, Option, Type, Expected, ExpectedType);
+	}
+}
+
+static uint32_t Random(void)
+{
+	static uint32_t State = 2463534242u;
+
+	State ^= State << 13;
+	State ^= State >> 17;
+	State ^= State << 5;
+	return State;
+}
+
+int main(void)
+{
+	unsigned int Option;
+	unsigned int i;
+	int          Freq;
+
+	for (Option = 0; Option < ARRAY_SIZE(DCS_Options); Option++)
+	{
+		const uint32_t Normal = REF_CalculateGolay(DCS_Options[Option] + 0x800U);
+		unsigned int   Polarity;
+
+		if (DCS_GetGolayCodeWord(CODE_TYPE_DIGITAL, Option) != Normal ||
+		    DCS_GetGolayCodeWord(CODE_TYPE_REVERSE_DIGITAL, Option) != (Normal ^ 0x7FFFFF))
+		{
+			printf("DCS_GetGolayCodeWord(%u) is off\n", Option);
+			gFailures++;
+		}
+
+		// every rotation of both polarities, as the chip may hand them over
+		for (Polarity = 0; Polarity < 2; Polarity++)
+		{
+			uint32_t Code = Polarity ? (Normal ^ 0x7FFFFF) : Normal;
+
+			for (i = 0; i < 23; i++)
+			{
+				CheckCdcss(Code);
+				Code = (Code >> 1) | ((Code & 1U) << 22);
+			}
+		}
+	}
+
+	for (i = 0; i < 2000000; i++)
+		CheckCdcss(Random() & 0x7FFFFF);
+
+	for (Freq = -500; Freq < 6000; Freq++)
+	{
+		if (DCS_GetCtcssCode(Freq) != REF_GetCtcssCode(Freq))
+		{
+			if (gFailures++ < 20)
+				printf("DCS_GetCtcssCode(%d) = %u, expected %u\n", Freq, DCS_GetCtcssCode(Freq), REF_GetCtcssCode(Freq));
+		}
+	}
+
+	printf("dcs: %u failures\n", gFailures);
+	return gFailures != 0;
+}
@@ -0,0 +1,193 @@
+// Runs a traffic mix through the digipeater with the Digi setting at 2:
+// fill-ins, WIDEn-N at every stage, paths routed by name, abuse, copies
+// from other digipeaters and our own frames coming back. Checks what goes
+// out for each frame and that nothing goes out without a callsign, then
+// times a random mix of 4000 frames through parse, dupe check and repeat.
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "app/aprs.h"
+#include "app/ax25.h"
+#include "app/digi.h"
+#include "settings.h"
+#include "tnc2.h"
+
+EEPROM_Config_t gEeprom;
+volatile uint32_t gGlobalSysTickCounter;
+
+static unsigned int failures;
+
+// what the digipeater queued last
+static char queued[AX25_IFRAME_MAX_SIZE];
+static uint16_t queued_len;
+static unsigned int queued_count;
+
+// the bundled printf wants this even though only snprintf is used
+void _putchar(char c) {
+    (void)c;
+}
+
+bool FSK_queue_repeat(char * data, uint16_t len) {
+    memcpy(queued, data, len);
+    queued_len = len;
+    queued_count++;
+    return true;
+}
+
+uint32_t FSK_repeat_latency_ms(void) {
+    return 0;
+}
+
+/** Writes a frame the TNC2 way, repeated digipeaters marked with '*' */
+static void decode_tnc2(const char * frame, uint16_t len, char * line) {
+    AX25View view;
+    char address[AX25_ADDRESS_STRING_SIZE + 1];
+
+    if(!AX25_parse(&view, frame, len)) {
+        strcpy(line, "?");
+        return;
+    }
+    AX25_address_to_string(&view, AX25_SOURCE, address);
+    line += sprintf(line, "%s>", address);
+    AX25_address_to_string(&view, AX25_DESTINATION, address);
+    line += sprintf(line, "%s", address);
+    for(uint8_t i = AX25_FIRST_DIGI; i < view.addresses; i++) {
+        AX25_address_to_string(&view, i, address);
+        line += sprintf(line, ",%s%s", address, AX25_repeated(&view, i) ? "*" : "");
+    }
+    sprintf(line, ":%.*s", (int)AX25_info_len(&view), AX25_info(&view));
+}
+
+/** What the digipeater sends for [line] heard at [at_10ms], "" for nothing */
+static void repeat(uint32_t at_10ms, const char * line, char * out) {
+    char frame[AX25_IFRAME_MAX_SIZE];
+    const uint16_t len = encode_tnc2(frame, line);
+    const unsigned int before = queued_count;
+    AX25View view;
+
+    out[0] = 0;
+    gGlobalSysTickCounter = 100000 + at_10ms;
+    if(!APRS_parse(&view, frame, len))
+        return;
+    DIGI_repeat(frame, &view, APRS_dupe_check(&view));
+    if(queued_count != before)
+        decode_tnc2(queued, queued_len, out);
+}
+
+static const struct {
+    uint32_t at_10ms;
+    const char * line;
+    const char * out;
+} mix[] = {
+    // fill-in, then the same frame from the wide area digipeater
+    {    0, "DL1ABC-7>APDR15,WIDE1-1,WIDE2-1:=4903.50N/07201.75W>Mobile", "DL1ABC-7>APDR15,N0CALL-9*,WIDE2-1:=4903.50N/07201.75W>Mobile" },
+    {   90, "DL1ABC-7>APDR15,DB0ABC*,WIDE2-1:=4903.50N/07201.75W>Mobile", "" },
+    // N counts down, the last hop puts our callsign in
+    {  200, "OE1XYZ>APRS,WIDE2-2::N0CALL-9 :hello{5", "OE1XYZ>APRS,WIDE2-1::N0CALL-9 :hello{5" },
+    {  300, "OE1XYZ>APRS,DB0ABC*,WIDE2-1:>status", "OE1XYZ>APRS,DB0ABC*,N0CALL-9*:>status" },
+    // more hops than the setting allows
+    {  400, "K1ABC>APRS,WIDE7-7:!4903.50N/07201.75W-", "" },
+    {  500, "K2ABC>APRS,WIDE3-3:!4903.50N/07201.75W-", "" },
+    // routed through us by name
+    {  600, "K3ABC>APRS,N0CALL-9,WIDE2-1:!4903.50N/07201.75W-", "K3ABC>APRS,N0CALL-9*,WIDE2-1:!4903.50N/07201.75W-" },
+    // nothing for us to do
+    {  700, "K4ABC>APRS:!4903.50N/07201.75W-", "" },
+    {  800, "K5ABC>APRS,DB0ABC*,DB0XYZ*:!4903.50N/07201.75W-", "" },
+    {  900, "N0CALL-9>APN000,WIDE1-1::OE1XYZ   :hi{7", "" },
+    { 1000, "K6ABC>APRS,RELAY:!4903.50N/07201.75W-", "" },
+    { 1100, "K7ABC>APRS,WIDE2-3:!4903.50N/07201.75W-", "" },
+    // our repeat and another digipeater's copy come back, then the same
+    // beacon again once the dupe window is over
+    { 1200, "K8ABC>APRS,WIDE1-1:!4903.50N/07201.75W-", "K8ABC>APRS,N0CALL-9*:!4903.50N/07201.75W-" },
+    { 1250, "K8ABC>APRS,N0CALL-9*:!4903.50N/07201.75W-", "" },
+    { 1300, "K8ABC>APRS,DB0ABC*:!4903.50N/07201.75W-", "" },
+    { 4500, "K8ABC>APRS,WIDE1-1:!4903.50N/07201.75W-", "K8ABC>APRS,N0CALL-9*:!4903.50N/07201.75W-" },
+};
+
+static void check_mix(void) {
+    for(uint8_t i = 0; i < sizeof(mix) / sizeof(mix[0]); i++) {
+        char out[512];
+
+        repeat(mix[i].at_10ms, mix[i].line, out);
+        if(strcmp(out, mix[i].out) != 0) {
+            printf("digi: %s\n  sent \"%s\"\n  not  \"%s\"\n", mix[i].line, out, mix[i].out);
+            failures++;
+        }
+    }
+    printf("digi: %u frames, forwarded %u, duplicates %u, too many hops %u\n",
+        (unsigned int)(sizeof(mix) / sizeof(mix[0])), digi_stats.forwarded,
+        digi_stats.duplicates, digi_stats.too_many_hops);
+}
+
+static void check_no_callsign(void) {
+    static const char * blank[] = { "", "      " };
+    char out[512];
+
+    for(uint8_t i = 0; i < sizeof(blank) / sizeof(blank[0]); i++) {
+        memset(gEeprom.APRS_CONFIG.callsign, 0, sizeof(gEeprom.APRS_CONFIG.callsign));
+        memcpy(gEeprom.APRS_CONFIG.callsign, blank[i], strlen(blank[i]));
+        repeat(90000 + i * 5000, "K9ABC>APRS,WIDE1-1:!4903.50N/07201.75W-", out);
+        if(out[0] != 0) {
+            printf("digi: repeated without a callsign: %s\n", out);
+            failures++;
+        }
+    }
+    strcpy(gEeprom.APRS_CONFIG.callsign, "N0CALL");
+}
+
+static void benchmark(void) {
+    static const char * paths[] = { "WIDE1-1,WIDE2-1", "WIDE2-2", "WIDE2-1", "DB0ABC*,WIDE2-1", "WIDE3-3", "", "DB0ABC*,DB0XYZ*", "N0CALL-9", "WIDE1-1" };
+    static char frames[4000][128];
+    static uint16_t lens[4000];
+    uint32_t seed = 3;
+    struct timespec start;
+    struct timespec end;
+
+    memset(&digi_stats, 0, sizeof(digi_stats));
+    for(int i = 0; i < 4000; i++) {
+        char line[128];
+        unsigned int station;
+        unsigned int path;
+
+        seed = seed * 1103515245 + 12345;
+        station = (seed >> 16) % 60;
+        seed = seed * 1103515245 + 12345;
+        path = (seed >> 16) % (sizeof(paths) / sizeof(paths[0]));
+        snprintf(line, sizeof(line), "S%uA>APRS%s%s:!49%02u.50N/07201.75W-beacon",
+            station, *paths[path] ? "," : "", paths[path], station);
+        lens[i] = encode_tnc2(frames[i], line);
+    }
+
+    // a frame every 1.5s
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(int i = 0; i < 4000; i++) {
+        AX25View view;
+
+        gGlobalSysTickCounter = 200000 + i * 150;
+        if(APRS_parse(&view, frames[i], lens[i]))
+            DIGI_repeat(frames[i], &view, APRS_dupe_check(&view));
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    printf("digi: random mix of 4000 frames, forwarded %u, duplicates %u, too many hops %u, %.0f ns per frame\n",
+        digi_stats.forwarded, digi_stats.duplicates, digi_stats.too_many_hops,
+        ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / 4000);
+}
+
+int main(void) {
+    strcpy(gEeprom.APRS_CONFIG.callsign, "N0CALL");
+    gEeprom.APRS_CONFIG.ssid = 9;
+    gEeprom.MESSENGER_CONFIG.data.digi = 2;
+
+    check_mix();
+    check_no_callsign();
+    benchmark();
+
+    printf("digi: %u failures\n", failures);
+
+    return failures != 0;
+}
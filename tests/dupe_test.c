@@ -0,0 +1,101 @@
+// Replays a multipath capture through the APRS duplicate cache, frame by
+// frame at the time it was heard, and applies the messenger's rules: a
+// message is shown if it wasn't heard before and acked if no window is
+// running for it. Counts what gets shown and acked with and without the
+// cache, and checks every frame against what should happen to it.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "app/aprs.h"
+#include "app/ax25.h"
+#include "settings.h"
+#include "tnc2.h"
+
+EEPROM_Config_t gEeprom;
+volatile uint32_t gGlobalSysTickCounter;
+
+static unsigned int failures;
+
+// the bundled printf wants this even though only snprintf is used
+void _putchar(char c) {
+    (void)c;
+}
+
+static const struct {
+    uint32_t at_10ms;
+    const char * line;
+    uint8_t show;
+    uint8_t ack;
+} capture[] = {
+    // heard direct, then over every digipeater around
+    {     0, "OE1XYZ>APRS,WIDE1-1,WIDE2-1::N0CALL-9 :Meet at 5?{17", 1, 1 },
+    {    90, "OE1XYZ>APRS,DB0ABC*,WIDE2-1::N0CALL-9 :Meet at 5?{17", 0, 0 },
+    {   160, "OE1XYZ>APRS,DB0XYZ*,WIDE2-1::N0CALL-9 :Meet at 5?{17", 0, 0 },
+    {   240, "OE1XYZ>APRS,DB0ABC*,DB0DEF*::N0CALL-9 :Meet at 5?{17", 0, 0 },
+    {   310, "OE1XYZ>APRS,DB0XYZ*,DB0QRS*::N0CALL-9 :Meet at 5?{17", 0, 0 },
+    {   500, "DL1ABC-7>APDR15,WIDE1-1:=4903.50N/07201.75W>Mobile", 0, 0 },
+    {   580, "DL1ABC-7>APDR15,DB0ABC*:=4903.50N/07201.75W>Mobile", 0, 0 },
+    {   650, "DL1ABC-7>APDR15,DB0XYZ*:=4903.50N/07201.75W>Mobile", 0, 0 },
+    {  1000, "SP5ABC>APRS,WIDE2-2::BLN1     :Net tonight", 1, 0 },
+    {  1070, "SP5ABC>APRS,DB0ABC*,WIDE2-1::BLN1     :Net tonight", 0, 0 },
+    // our ack got lost, the sender retries after 30s and 60s and gets another
+    {  3020, "OE1XYZ>APRS,WIDE1-1,WIDE2-1::N0CALL-9 :Meet at 5?{17", 0, 1 },
+    {  3100, "OE1XYZ>APRS,DB0ABC*,WIDE2-1::N0CALL-9 :Meet at 5?{17", 0, 0 },
+    {  3190, "OE1XYZ>APRS,DB0XYZ*,WIDE2-1::N0CALL-9 :Meet at 5?{17", 0, 0 },
+    {  3250, "OE1XYZ>APRS,DB0ABC*,DB0DEF*::N0CALL-9 :Meet at 5?{17", 0, 0 },
+    {  9010, "OE1XYZ>APRS,WIDE1-1,WIDE2-1::N0CALL-9 :Meet at 5?{17", 0, 1 },
+    {  9090, "OE1XYZ>APRS,DB0ABC*,WIDE2-1::N0CALL-9 :Meet at 5?{17", 0, 0 },
+    // a new message with the same text has a new id
+    { 12000, "OE1XYZ>APRS,WIDE1-1::N0CALL-9 :Meet at 5?{18", 1, 1 },
+    { 12080, "OE1XYZ>APRS,DB0ABC*::N0CALL-9 :Meet at 5?{18", 0, 0 },
+    // the same id from somebody else is another message
+    { 12100, "K1ABC>APRS,WIDE1-1::N0CALL-9 :hi{17", 1, 1 },
+    { 12170, "K1ABC>APRS,DB0ABC*::N0CALL-9 :hi{17", 0, 0 },
+    // long after it expired the first message is news again
+    { 80000, "OE1XYZ>APRS,WIDE1-1::N0CALL-9 :Meet at 5?{17", 1, 1 },
+};
+
+int main(void) {
+    unsigned int shown[2] = { 0 };
+    unsigned int acks[2] = { 0 };
+
+    strcpy(gEeprom.APRS_CONFIG.callsign, "N0CALL");
+    gEeprom.APRS_CONFIG.ssid = 9;
+
+    for(uint8_t cache = 0; cache < 2; cache++) {
+        for(uint8_t i = 0; i < sizeof(capture) / sizeof(capture[0]); i++) {
+            char frame[256];
+            const uint16_t len = encode_tnc2(frame, capture[i].line);
+            AX25View view;
+
+            gGlobalSysTickCounter = 100000 + capture[i].at_10ms;
+            if(!APRS_parse(&view, frame, len)) {
+                printf("dupe: can't parse %s\n", capture[i].line);
+                return 1;
+            }
+
+            const APRSType type = APRS_get_type(&view);
+            const uint32_t heard = (cache && type == APRS_TYPE_MESSAGE) ? APRS_dupe_check(&view) : APRS_DUPE_NEVER;
+            const uint8_t show = type == APRS_TYPE_MESSAGE && heard == APRS_DUPE_NEVER;
+            const uint8_t ack = type == APRS_TYPE_MESSAGE && heard >= APRS_DUPE_WINDOW_10MS &&
+                APRS_destined_to_user(&view) && APRS_get_msg_id(&view) != 0;
+
+            shown[cache] += show;
+            acks[cache] += ack;
+
+            if(cache && (show != capture[i].show || ack != capture[i].ack)) {
+                printf("dupe: %s shown %u acked %u, expected %u %u\n",
+                    capture[i].line, show, ack, capture[i].show, capture[i].ack);
+                failures++;
+            }
+        }
+    }
+
+    printf("dupe: without cache %u shown, %u acked\n", shown[0], acks[0]);
+    printf("dupe: with cache    %u shown, %u acked, %u ack transmissions suppressed\n",
+        shown[1], acks[1], acks[0] - acks[1]);
+    printf("dupe: %u failures\n", failures);
+
+    return failures != 0;
+}
@@ -0,0 +1,189 @@
+// Checks the Reed-Solomon coding in app/fec.c: every frame with up to
+// FEC_PARITY / 2 bad bytes comes back intact, bursts up to 57 bits are put
+// right, a damaged length copy is outvoted and FIFO padding is ignored.
+// Frames with more damage than that have to be refused or, rarely,
+// miscorrected, the split is printed. Then times encode and decode.
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "app/fec.h"
+
+static unsigned int gFailures;
+
+static uint32_t Random(void) {
+    static uint32_t state = 0x2545F491;
+
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static uint16_t random_frame(char * src, char * frame) {
+    const uint16_t len = 1 + Random() % FEC_MAX_DATA;
+
+    for(uint16_t i = 0; i < len; i++)
+        src[i] = Random();
+    return FEC_encode(src, len, frame);
+}
+
+static void check(int ok, const char * what, uint16_t len) {
+    if(!ok) {
+        printf("fec: %s failed, length %u\n", what, len);
+        gFailures++;
+    }
+}
+
+/** Damages [errors] different bytes of the codeword */
+static void damage(char * frame, uint16_t n, unsigned int errors) {
+    uint8_t hit[256] = { 0 };
+    const uint16_t codeword = n - FEC_HEADER;
+
+    while(errors) {
+        const uint16_t at = Random() % codeword;
+        if(hit[at])
+            continue;
+        hit[at] = 1;
+        frame[FEC_HEADER + at] ^= 1 + Random() % 255;
+        errors--;
+    }
+}
+
+static void check_correctable(void) {
+    char src[256];
+    char frame[FEC_ENCODED_SIZE(FEC_MAX_DATA) + 8];
+
+    for(int i = 0; i < 200000; i++) {
+        const uint16_t n = random_frame(src, frame);
+        const uint16_t len = n - FEC_HEADER - FEC_PARITY;
+
+        damage(frame, n, Random() % (FEC_PARITY / 2 + 1));
+        check(FEC_decode(frame, n) == len && memcmp(frame, src, len) == 0, "correction", len);
+    }
+}
+
+static void check_bursts(void) {
+    char src[256];
+    char frame[FEC_ENCODED_SIZE(FEC_MAX_DATA) + 8];
+
+    for(int i = 0; i < 50000; i++) {
+        const uint16_t n = random_frame(src, frame);
+        const uint16_t len = n - FEC_HEADER - FEC_PARITY;
+        const uint16_t bits = (n - FEC_HEADER) * 8;
+        const uint16_t burst = 1 + Random() % 57;
+        const uint16_t start = FEC_HEADER * 8 + Random() % (bits - (burst < bits ? burst : bits) + 1);
+
+        for(uint16_t b = start; b < start + burst && b < n * 8; b++)
+            frame[b / 8] ^= 0x80 >> (b % 8);
+        check(FEC_decode(frame, n) == len && memcmp(frame, src, len) == 0, "burst", len);
+    }
+}
+
+static void check_header(void) {
+    char src[256];
+    char frame[FEC_ENCODED_SIZE(FEC_MAX_DATA) + 8];
+
+    for(int i = 0; i < 10000; i++) {
+        const uint16_t n = random_frame(src, frame);
+        const uint16_t len = n - FEC_HEADER - FEC_PARITY;
+        const uint16_t padding = Random() % 8;
+
+        // one length copy wrong, padding after the parity
+        frame[Random() % FEC_HEADER] ^= 1 + Random() % 255;
+        memset(frame + n, 0xAA, padding);
+        check(FEC_decode(frame, n + padding) == len && memcmp(frame, src, len) == 0, "header", len);
+    }
+}
+
+static void check_uncorrectable(void) {
+    char src[256];
+    char frame[FEC_ENCODED_SIZE(FEC_MAX_DATA) + 8];
+    unsigned int refused = 0;
+    unsigned int wrong = 0;
+    const int frames = 100000;
+
+    for(int i = 0; i < frames; i++) {
+        const uint16_t n = random_frame(src, frame);
+        const uint16_t len = n - FEC_HEADER - FEC_PARITY;
+        unsigned int errors = FEC_PARITY / 2 + 1 + Random() % 8;
+
+        if(errors > len + FEC_PARITY)
+            errors = len + FEC_PARITY;
+        damage(frame, n, errors);
+
+        const int16_t decoded = FEC_decode(frame, n);
+        if(decoded < 0)
+            refused++;
+        else if(decoded != len || memcmp(frame, src, len) != 0)
+            wrong++;
+    }
+    printf("fec: over %u bad bytes, %u of %d refused, %u miscorrected\n",
+        FEC_PARITY / 2, refused, frames, wrong);
+}
+
+static double elapsed_ns(const struct timespec * start, const struct timespec * end) {
+    return (end->tv_sec - start->tv_sec) * 1e9 + (end->tv_nsec - start->tv_nsec);
+}
+
+static void benchmark(void) {
+    static const uint16_t lengths[] = { 16, 64, 128, FEC_MAX_DATA };
+    char src[256];
+    char frame[FEC_ENCODED_SIZE(FEC_MAX_DATA)];
+    char work[FEC_ENCODED_SIZE(FEC_MAX_DATA)];
+    const int rounds = 20000;
+    struct timespec start;
+    struct timespec end;
+
+    for(unsigned int l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+        const uint16_t len = lengths[l];
+        uint16_t n = 0;
+        double encode;
+        double clean;
+        double dirty;
+
+        for(uint16_t i = 0; i < len; i++)
+            src[i] = Random();
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for(int i = 0; i < rounds; i++)
+            n = FEC_encode(src, len, frame);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        encode = elapsed_ns(&start, &end) / rounds;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for(int i = 0; i < rounds; i++) {
+            memcpy(work, frame, n);
+            FEC_decode(work, n);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        clean = elapsed_ns(&start, &end) / rounds;
+
+        damage(frame, n, FEC_PARITY / 2);
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for(int i = 0; i < rounds; i++) {
+            memcpy(work, frame, n);
+            FEC_decode(work, n);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        dirty = elapsed_ns(&start, &end) / rounds;
+
+        printf("fec: %3u bytes encode %.0f ns, decode clean %.0f ns, %u bad %.0f ns\n",
+            len, encode, clean, FEC_PARITY / 2, dirty);
+    }
+}
+
+int main(void) {
+    check_correctable();
+    check_bursts();
+    check_header();
+    check_uncorrectable();
+    benchmark();
+
+    printf("fec: %u failures\n", gFailures);
+
+    return gFailures != 0;
+}
@@ -0,0 +1,357 @@
+// Frames payloads with HDLC_frame and checks the bits against a framer that
+// stuffs and NRZI encodes one bit at a time, then feeds them back through
+// HDLC_deframer_push. Covers runs of ones across byte boundaries, all-ones
+// payloads and flags inside the data, then times the byte wide NRZI and
+// framer against the per-bit loops they replaced.
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "app/hdlc/hdlc.h"
+
+#define DEST_SIZE (HDLC_RX_BUFFER_SIZE * 2 + 16)
+
+static unsigned int failures;
+
+// what the deframer handed over last
+static char delivered[HDLC_RX_BUFFER_SIZE];
+static uint16_t delivered_len;
+static unsigned int delivered_count;
+
+static void frame_callback(char * frame, uint16_t len) {
+    memcpy(delivered, frame, len);
+    delivered_len = len;
+    delivered_count++;
+}
+
+/* The per-bit NRZI loops FSK_encode_nrzi and FSK_decode_nrzi used to run */
+
+static void ref_encode_nrzi(char * buffer, size_t length, uint8_t nrzi_state) {
+    for (size_t i = 0; i < length; i++) {
+        const char original_byte = buffer[i];
+
+        buffer[i] = 0;
+        for (int8_t bit_idx = 7; bit_idx >= 0; bit_idx--) {
+            if (((original_byte >> bit_idx) & 0x01) == 0)
+                nrzi_state = !nrzi_state;
+            if (nrzi_state)
+                buffer[i] |= (1 << bit_idx);
+        }
+    }
+}
+
+static void ref_decode_nrzi(char * buffer, size_t length, uint8_t prev_bit) {
+    for (size_t i = 0; i < length; i++) {
+        const char encoded_byte = buffer[i];
+
+        buffer[i] = 0;
+        for (int8_t bit_idx = 7; bit_idx >= 0; bit_idx--) {
+            const uint8_t current_bit = (encoded_byte >> bit_idx) & 0x01;
+            if (current_bit == prev_bit)
+                buffer[i] |= (1 << bit_idx);
+            prev_bit = current_bit;
+        }
+    }
+}
+
+/* A framer that stuffs one bit at a time, MSB first into each FIFO byte */
+
+typedef struct {
+    char * dest;
+    uint16_t len;
+    uint8_t count;
+    uint8_t ones;
+} ref_framer;
+
+static void ref_put_bit(ref_framer * self, uint8_t bit) {
+    if (self->count == 0)
+        self->dest[self->len] = 0;
+    self->dest[self->len] |= bit << (7 - self->count);
+    if (++self->count == 8) {
+        self->count = 0;
+        self->len++;
+    }
+}
+
+static void ref_put_flag(ref_framer * self) {
+    for (uint8_t i = 0; i < 8; i++)
+        ref_put_bit(self, (HDLC_FLAG >> i) & 0x01);
+    self->ones = 0;
+}
+
+static void ref_put_octet(ref_framer * self, uint8_t octet) {
+    for (uint8_t i = 0; i < 8; i++) {
+        const uint8_t bit = (octet >> i) & 0x01;
+
+        ref_put_bit(self, bit);
+        self->ones = bit ? self->ones + 1 : 0;
+        if (self->ones == 5) {
+            ref_put_bit(self, 0);
+            self->ones = 0;
+        }
+    }
+}
+
+static uint16_t ref_frame(const char * src, uint16_t len, char * dest, uint8_t flags, uint8_t nrzi, uint8_t level) {
+    ref_framer framer = { .dest = dest };
+    FCS_SIZE fcs = FCS_INIT_VALUE;
+
+    while (flags--)
+        ref_put_flag(&framer);
+    for (uint16_t i = 0; i < len; i++) {
+        fcs = calc_fcs(fcs, src[i]);
+        ref_put_octet(&framer, src[i]);
+    }
+    fcs ^= FCS_INVERT_MASK;
+    ref_put_octet(&framer, fcs & 0xFF);
+    ref_put_octet(&framer, fcs >> 8);
+    ref_put_flag(&framer);
+    for (uint8_t i = 0; framer.count; i++)
+        ref_put_bit(&framer, (HDLC_FLAG >> i) & 0x01);
+
+    if (nrzi)
+        ref_encode_nrzi(dest, framer.len, level);
+    return framer.len;
+}
+
+/** Feeds on-air bytes to a deframer two at a time, padding with a flag */
+static unsigned int deframe(const char * bytes, uint16_t len, uint8_t nrzi, uint8_t level) {
+    HDLCDeframer deframer;
+    unsigned int frames = 0;
+
+    HDLC_deframer_init(&deframer, frame_callback, nrzi);
+    HDLC_deframer_reset(&deframer, level);
+    for (uint16_t i = 0; i + 1 < len; i += 2)
+        frames += HDLC_deframer_push(&deframer, (uint8_t)bytes[i] | ((uint8_t)bytes[i + 1] << 8));
+    if (len & 1) {
+        uint8_t pad = HDLC_FLAG;
+        uint8_t pad_level = bytes[len - 1] & 0x01;
+
+        if (nrzi)
+            pad = HDLC_nrzi_encode(pad, &pad_level);
+        frames += HDLC_deframer_push(&deframer, (uint8_t)bytes[len - 1] | (pad << 8));
+    }
+    return frames;
+}
+
+/** Longest run of ones between the opening and closing flags */
+static uint8_t longest_run(const char * bytes, uint16_t len, uint8_t flags) {
+    uint8_t run = 0;
+    uint8_t longest = 0;
+
+    // skip the opening flags, the closing one and the fill after it
+    for (uint32_t bit = flags * 8; bit + 16 <= len * 8u; bit++) {
+        if ((bytes[bit / 8] >> (7 - bit % 8)) & 0x01) {
+            if (++run > longest)
+                longest = run;
+        } else {
+            run = 0;
+        }
+    }
+    return longest;
+}
+
+static void check_frame(const char * what, const char * src, uint16_t len, uint8_t flags, uint8_t nrzi, uint8_t level) {
+    static char bytes[DEST_SIZE];
+    static char expected[DEST_SIZE];
+    const uint16_t bytes_len = HDLC_frame(src, len, bytes, sizeof(bytes), flags, nrzi, level);
+    const uint16_t expected_len = ref_frame(src, len, expected, flags, nrzi, level);
+
+    if (bytes_len != expected_len || memcmp(bytes, expected, bytes_len) != 0) {
+        printf("hdlc: %s, %u bytes, nrzi %u level %u: %u bytes on air, expected %u\n",
+            what, len, nrzi, level, bytes_len, expected_len);
+        failures++;
+        return;
+    }
+
+    if (!nrzi && longest_run(bytes, bytes_len, flags) > 5) {
+        printf("hdlc: %s, %u bytes: six ones in a row inside the frame\n", what, len);
+        failures++;
+    }
+
+    delivered_count = 0;
+    if (deframe(bytes, bytes_len, nrzi, level) != 1 || delivered_count != 1 ||
+            delivered_len != len || memcmp(delivered, src, len) != 0) {
+        printf("hdlc: %s, %u bytes, nrzi %u level %u: deframed %u frames of %u bytes\n",
+            what, len, nrzi, level, delivered_count, delivered_len);
+        failures++;
+    }
+}
+
+static void check_all_ways(const char * what, const char * src, uint16_t len) {
+    for (uint8_t flags = 1; flags <= 3; flags += 2) {
+        check_frame(what, src, len, flags, 0, 0);
+        check_frame(what, src, len, flags, 1, 0);
+        check_frame(what, src, len, flags, 1, 1);
+    }
+}
+
+static void check_edge_cases(void) {
+    char payload[AX25_IFRAME_MAX_SIZE];
+
+    // five ones ending one byte, more at the start of the next, at every
+    // offset so the run crosses the FIFO byte boundaries too
+    for (uint8_t shift = 0; shift < 8; shift++) {
+        memset(payload, 0x55, sizeof(payload));
+        for (uint16_t i = 16; i + 1 < 64; i += 3) {
+            const uint16_t run = 0x1F << (3 + shift);
+            payload[i] = run & 0xFF;
+            payload[i + 1] = run >> 8;
+        }
+        check_all_ways("ones across bytes", payload, 64);
+    }
+
+    memset(payload, 0xF8, 64);
+    for (uint16_t i = 1; i < 64; i += 2)
+        payload[i] = 0x03;
+    check_all_ways("five ones then two", payload, 64);
+
+    memset(payload, 0xFF, sizeof(payload));
+    for (uint16_t len = HDLC_MIN_FRAME_SIZE - 2; len <= 40; len++)
+        check_all_ways("all ones", payload, len);
+    check_all_ways("all ones", payload, AX25_IFRAME_MAX_SIZE);
+
+    memset(payload, HDLC_FLAG, sizeof(payload));
+    check_all_ways("flags", payload, 32);
+    memcpy(payload, "N0CALL\x7E\x7E\x7E\x7E\x7E\x7E\x7E\x7E\x03\xF0~~~~", 20);
+    check_all_ways("flags in the data", payload, 20);
+
+    // the abort sequence and the start of a flag inside the data
+    memset(payload, 0x00, 32);
+    payload[20] = 0x7F;
+    payload[21] = 0xFE;
+    payload[22] = 0x3F;
+    check_all_ways("seven ones", payload, 32);
+}
+
+static uint32_t seed = 1;
+
+static uint8_t random_byte(void) {
+    seed = seed * 1103515245 + 12345;
+    return seed >> 16;
+}
+
+static void check_random(void) {
+    char payload[AX25_IFRAME_MAX_SIZE];
+
+    for (unsigned int i = 0; i < 2000; i++) {
+        const uint16_t len = HDLC_MIN_FRAME_SIZE - 2 + random_byte() % (AX25_IFRAME_MAX_SIZE - HDLC_MIN_FRAME_SIZE + 3);
+        // ones heavy payloads stuff a lot more
+        const uint8_t mask = (i & 1) ? 0x00 : random_byte();
+
+        for (uint16_t j = 0; j < len; j++)
+            payload[j] = random_byte() | mask;
+        check_frame("random", payload, len, 1 + i % 4, i % 3 != 0, (i >> 2) & 1);
+    }
+
+    // too small a destination gives nothing back
+    {
+        char bytes[16];
+        check_frame("fits", payload, 40, 1, 0, 0);
+        if (HDLC_frame(payload, 40, bytes, sizeof(bytes), 1, 0, 0) != 0) {
+            printf("hdlc: framed into a buffer too small\n");
+            failures++;
+        }
+    }
+}
+
+static double ns_since(const struct timespec * start) {
+    struct timespec end;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start->tv_sec) * 1e9 + (end.tv_nsec - start->tv_nsec);
+}
+
+static void benchmark(void) {
+    enum { ROUNDS = 4000 };
+    static char payload[AX25_IFRAME_MAX_SIZE];
+    static char bytes[DEST_SIZE];
+    struct timespec start;
+    uint16_t len = 0;
+    uint8_t level = 0;
+    unsigned int sink = 0;
+    double ns;
+
+    for (uint16_t i = 0; i < sizeof(payload); i++)
+        payload[i] = random_byte();
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned int i = 0; i < ROUNDS; i++) {
+        ref_encode_nrzi(payload, sizeof(payload), i & 1);
+        sink += payload[i % sizeof(payload)];
+    }
+    ns = ns_since(&start);
+    printf("hdlc: nrzi encode, per bit  %6.2f ns/byte\n", ns / ROUNDS / sizeof(payload));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned int i = 0; i < ROUNDS; i++) {
+        level = i & 1;
+        for (uint16_t j = 0; j < sizeof(payload); j++)
+            payload[j] = HDLC_nrzi_encode(payload[j], &level);
+        sink += payload[i % sizeof(payload)];
+    }
+    ns = ns_since(&start);
+    printf("hdlc: nrzi encode, per byte %6.2f ns/byte\n", ns / ROUNDS / sizeof(payload));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned int i = 0; i < ROUNDS; i++) {
+        ref_decode_nrzi(payload, sizeof(payload), i & 1);
+        sink += payload[i % sizeof(payload)];
+    }
+    ns = ns_since(&start);
+    printf("hdlc: nrzi decode, per bit  %6.2f ns/byte\n", ns / ROUNDS / sizeof(payload));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned int i = 0; i < ROUNDS; i++) {
+        level = i & 1;
+        for (uint16_t j = 0; j < sizeof(payload); j++)
+            payload[j] = HDLC_nrzi_decode(payload[j], &level);
+        sink += payload[i % sizeof(payload)];
+    }
+    ns = ns_since(&start);
+    printf("hdlc: nrzi decode, per byte %6.2f ns/byte\n", ns / ROUNDS / sizeof(payload));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned int i = 0; i < ROUNDS; i++) {
+        payload[0] = i;
+        len = ref_frame(payload, sizeof(payload), bytes, 4, 1, 1);
+        sink += bytes[len - 1];
+    }
+    ns = ns_since(&start);
+    printf("hdlc: framing, per bit      %6.2f ns/byte, %.1f MB/s\n",
+        ns / ROUNDS / sizeof(payload), ROUNDS * sizeof(payload) * 1e3 / ns);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned int i = 0; i < ROUNDS; i++) {
+        payload[0] = i;
+        len = HDLC_frame(payload, sizeof(payload), bytes, sizeof(bytes), 4, 1, 1);
+        sink += bytes[len - 1];
+    }
+    ns = ns_since(&start);
+    printf("hdlc: HDLC_frame            %6.2f ns/byte, %.1f MB/s\n",
+        ns / ROUNDS / sizeof(payload), ROUNDS * sizeof(payload) * 1e3 / ns);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned int i = 0; i < ROUNDS; i++)
+        sink += deframe(bytes, len, 1, 1);
+    ns = ns_since(&start);
+    printf("hdlc: HDLC_deframer_push    %6.2f ns/byte, %.1f MB/s\n",
+        ns / ROUNDS / len, ROUNDS * len * 1e3 / ns);
+
+    // keeps the loops above from being optimised away
+    if (sink == 0x5A5A5A5A)
+        printf("hdlc: %u\n", sink);
+}
+
+int main(void) {
+    check_edge_cases();
+    check_random();
+    benchmark();
+
+    printf("hdlc: %u failures\n", failures);
+
+    return failures != 0;
+}
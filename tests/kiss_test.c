@@ -0,0 +1,436 @@
+// Loopback through the KISS TNC. Frames from the host go through a 256 byte
+// ring the way the UART DMA delivers them, with the TX queue filling up and
+// draining slower than the host sends. Every frame that reaches the queue
+// has to be one the host sent, whole and in order, and every other one has
+// to be counted as dropped. Frames heard on air go back out through a small
+// UART FIFO and have to decode to what was heard. Then times frames per
+// second and latency both ways.
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "app/fsk.h"
+#include "app/kiss.h"
+#include "driver/uart.h"
+
+#define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
+
+#define RING_SIZE   256 // UART_DMA_Buffer
+#define QUEUE_SIZE  FSK_TX_QUEUE_SIZE
+#define FIFO_SIZE   8   // UART TX FIFO
+
+static unsigned int gFailures;
+
+// what the host sent, in order
+static char     gSent[400][FSK_TX_FRAME_SIZE + 8];
+static uint16_t gSentLength[400];
+static unsigned int gSentCount;
+static unsigned int gNextMatch;
+
+// TX queue
+static unsigned int gQueueUsed;
+static unsigned int gQueuedCount;
+
+// bytes the TNC sent to the host
+static uint8_t      gToHost[8192];
+static unsigned int gToHostLength;
+
+// while timing the queue takes everything and the UART only counts bytes
+static bool            gBenchmark;
+static struct timespec gQueuedAt;
+static uint32_t        gTickBudget;
+static uint32_t        gSentToHost;
+
+bool FSK_queue_data(char *data, uint16_t len, uint8_t holdoff_10ms)
+{
+	(void)holdoff_10ms;
+
+	if (gBenchmark)
+	{
+		(void)data;
+		(void)len;
+		clock_gettime(CLOCK_MONOTONIC, &gQueuedAt);
+		gQueuedCount++;
+		return true;
+	}
+
+	if (gQueueUsed == QUEUE_SIZE)
+		return false;
+	gQueueUsed++;
+	gQueuedCount++;
+
+	// has to be the next frame sent, or one after it if some were dropped
+	while (gNextMatch < gSentCount)
+	{
+		const unsigned int i = gNextMatch++;
+
+		if (gSentLength[i] == len && memcmp(gSent[i], data, len) == 0)
+			return true;
+	}
+	printf("kiss: queued a frame the host never sent, length %u\n", len);
+	gFailures++;
+	return true;
+}
+
+uint32_t UART_SendSome(const void *pBuffer, uint32_t Size)
+{
+	if (gBenchmark)
+	{	// what the wire takes in a tick, the FIFO refills as it drains
+		(void)pBuffer;
+		if (Size > gTickBudget)
+			Size = gTickBudget;
+		gTickBudget -= Size;
+		gSentToHost += Size;
+		return Size;
+	}
+
+	if (Size > FIFO_SIZE)
+		Size = FIFO_SIZE;
+	if (gToHostLength + Size > sizeof(gToHost))
+		Size = sizeof(gToHost) - gToHostLength;
+	memcpy(gToHost + gToHostLength, pBuffer, Size);
+	gToHostLength += Size;
+	return Size;
+}
+
+static char         gReport[128];
+
+// the bundled printf wants this even though only snprintf is used
+void _putchar(char c)
+{
+	(void)c;
+}
+
+void UART_Send(const void *pBuffer, uint32_t Size)
+{
+	if (Size >= sizeof(gReport))
+		Size = sizeof(gReport) - 1;
+	memcpy(gReport, pBuffer, Size);
+	gReport[Size] = 0;
+}
+
+static uint32_t Random(void)
+{
+	static uint32_t State = 0x9E3779B9;
+
+	State ^= State << 13;
+	State ^= State >> 17;
+	State ^= State << 5;
+	return State;
+}
+
+static void Check(int Ok, const char *What)
+{
+	if (!Ok)
+	{
+		printf("kiss: %s failed\n", What);
+		gFailures++;
+	}
+}
+
+static uint16_t Escape(const uint8_t *pFrame, uint16_t Length, uint8_t *pOut)
+{
+	uint16_t n = 0;
+
+	pOut[n++] = 0xC0;
+	pOut[n++] = 0x00;
+	for (uint16_t i = 0; i < Length; i++)
+	{
+		if (pFrame[i] == 0xC0)
+		{
+			pOut[n++] = 0xDB;
+			pOut[n++] = 0xDC;
+		}
+		else
+		if (pFrame[i] == 0xDB)
+		{
+			pOut[n++] = 0xDB;
+			pOut[n++] = 0xDD;
+		}
+		else
+			pOut[n++] = pFrame[i];
+	}
+	pOut[n++] = 0xC0;
+	return n;
+}
+
+// host to air, the host writes the ring faster than the TX queue drains
+static void CheckHostToAir(void)
+{
+	static uint8_t Stream[400 * (2 * FSK_TX_FRAME_SIZE + 4)];
+	uint8_t        Ring[RING_SIZE];
+	uint32_t       StreamLength = 0;
+	uint32_t       Written      = 0;
+	uint32_t       Read         = 0;
+	unsigned int   Long         = 0;
+	unsigned int   Tick         = 0;
+
+	for (gSentCount = 0; gSentCount < ARRAY_SIZE(gSent); gSentCount++)
+	{
+		uint8_t *pFrame = (uint8_t *)gSent[gSentCount];
+		uint16_t Length;
+
+		switch (Random() % 8)
+		{
+			case 0: // longest there is, every byte escaped
+				Length = FSK_TX_FRAME_SIZE;
+				memset(pFrame, (Random() & 1) ? 0xC0 : 0xDB, Length);
+				break;
+			case 1: // too long, has to be dropped and counted
+				Length = FSK_TX_FRAME_SIZE + 1 + Random() % 7;
+				for (uint16_t i = 0; i < Length; i++)
+					pFrame[i] = Random();
+				Long++;
+				break;
+			default:
+				Length = 1 + Random() % FSK_TX_FRAME_SIZE;
+				for (uint16_t i = 0; i < Length; i++)
+					pFrame[i] = (Random() & 3) ? Random() : 0xC0;
+				break;
+		}
+		gSentLength[gSentCount] = Length;
+		StreamLength += Escape(pFrame, Length, Stream + StreamLength);
+	}
+
+	KISS_Start();
+
+	// the DMA writes 48 bytes between two passes of the main loop, a frame
+	// leaves the queue every sixteenth pass
+	while (Read < StreamLength)
+	{
+		for (int i = 0; i < 48 && Written < StreamLength; i++, Written++)
+			Ring[Written % RING_SIZE] = Stream[Written];
+
+		if (Written - Read > RING_SIZE)
+		{
+			Check(0, "keeping up with the ring");
+			return;
+		}
+
+		// what UART_IsCommandAvailable does in KISS mode
+		while (Read != Written)
+			KISS_Feed(Ring[Read++ % RING_SIZE]);
+
+		if (++Tick % 16 == 0 && gQueueUsed > 0)
+			gQueueUsed--;
+	}
+
+	KISS_Report();
+
+	{
+		unsigned int Queued;
+		unsigned int Full;
+		unsigned int TooLong;
+		unsigned int Dropped;
+
+		Check(sscanf(gReport, "KISS tx %u full %u long %u rx-dropped %u", &Queued, &Full, &TooLong, &Dropped) == 4, "report");
+		Check(Queued == gQueuedCount, "queued count");
+		Check(TooLong == Long, "too long count");
+		Check(Queued + Full + TooLong == gSentCount, "every frame accounted for");
+		Check(Full > 0, "queue filling up");
+		printf("kiss: %u frames, %u queued, %u dropped full, %u too long\n", gSentCount, Queued, Full, TooLong);
+	}
+}
+
+// air to host, through the UART FIFO a few bytes per tick
+static void CheckAirToHost(void)
+{
+	char         Frames[40][FSK_TX_FRAME_SIZE];
+	uint16_t     Lengths[40];
+	unsigned int Count;
+	unsigned int Frame = 0;
+	unsigned int At    = 0;
+
+	gToHostLength = 0;
+
+	for (Count = 0; Count < ARRAY_SIZE(Frames); Count++)
+	{
+		Lengths[Count] = 1 + Random() % 40;
+		for (uint16_t i = 0; i < Lengths[Count]; i++)
+			Frames[Count][i] = (Random() & 3) ? Random() : 0xDB;
+
+		KISS_SendFrame(Frames[Count], Lengths[Count]);
+		if (Count % 4 == 3)
+			for (int t = 0; t < 20; t++)
+				KISS_TimeSlice10ms();
+	}
+	for (int t = 0; t < 200; t++)
+		KISS_TimeSlice10ms();
+
+	// decode what reached the host
+	while (At < gToHostLength && Frame < Count)
+	{
+		uint8_t  Decoded[2 * FSK_TX_FRAME_SIZE];
+		uint16_t Length = 0;
+
+		Check(gToHost[At++] == 0xC0 && gToHost[At++] == 0x00, "frame start");
+		while (At < gToHostLength && gToHost[At] != 0xC0)
+		{
+			uint8_t Byte = gToHost[At++];
+
+			if (Byte == 0xDB)
+				Byte = (gToHost[At++] == 0xDC) ? 0xC0 : 0xDB;
+			Decoded[Length++] = Byte;
+		}
+		At++;
+
+		Check(Length == Lengths[Frame] && memcmp(Decoded, Frames[Frame], Length) == 0, "frame to the host");
+		Frame++;
+	}
+	Check(Frame == Count && At == gToHostLength, "all frames to the host");
+}
+
+static double Nanoseconds(const struct timespec *pStart, const struct timespec *pEnd)
+{
+	return (pEnd->tv_sec - pStart->tv_sec) * 1e9 + (pEnd->tv_nsec - pStart->tv_nsec);
+}
+
+// host to air: how fast KISS_Feed takes APRS sized frames apart, and how
+// long after the closing FEND a frame is in the TX queue
+static void BenchmarkHostToAir(void)
+{
+	enum { FRAMES = 1000, ROUNDS = 20 };
+	static uint8_t  Stream[FRAMES * (2 * 120 + 4)];
+	static uint32_t Ends[FRAMES];
+	uint32_t        StreamLength = 0;
+	struct timespec Start;
+	struct timespec End;
+	double          Latency    = 0;
+	double          MaxLatency = 0;
+	double          Ns;
+
+	for (unsigned int i = 0; i < FRAMES; i++)
+	{
+		uint8_t        Frame[120];
+		const uint16_t Length = 20 + Random() % 100;
+
+		for (uint16_t j = 0; j < Length; j++)
+			Frame[j] = (Random() % 64) ? 0x20 + Random() % 0x5F : 0xC0;
+		StreamLength += Escape(Frame, Length, Stream + StreamLength);
+		Ends[i] = StreamLength - 1;
+	}
+
+	gBenchmark   = true;
+	gQueuedCount = 0;
+	KISS_Start();
+
+	clock_gettime(CLOCK_MONOTONIC, &Start);
+	for (unsigned int r = 0; r < ROUNDS; r++)
+		for (uint32_t i = 0; i < StreamLength; i++)
+			KISS_Feed(Stream[i]);
+	clock_gettime(CLOCK_MONOTONIC, &End);
+	Ns = Nanoseconds(&Start, &End);
+
+	Check(gQueuedCount == FRAMES * ROUNDS, "benchmark frames queued");
+
+	// the last byte of each frame on its own, timed to the queue
+	for (uint32_t i = 0, Frame = 0; i < StreamLength; i++)
+	{
+		if (i == Ends[Frame])
+		{
+			double Took;
+
+			clock_gettime(CLOCK_MONOTONIC, &Start);
+			KISS_Feed(Stream[i]);
+			Took = Nanoseconds(&Start, &gQueuedAt);
+			Latency += Took;
+			if (Took > MaxLatency)
+				MaxLatency = Took;
+			Frame++;
+		}
+		else
+			KISS_Feed(Stream[i]);
+	}
+
+	printf("kiss: host to air, %.0f frames/s, %.1f MB/s, FEND to queue %.0f ns, max %.0f ns\n",
+		FRAMES * ROUNDS * 1e9 / Ns, (double)StreamLength * ROUNDS * 1e3 / Ns,
+		Latency / FRAMES, MaxLatency);
+
+	gBenchmark = false;
+}
+
+// air to host: frames heard every 30 ms go out at 38400 baud, 38 bytes a
+// tick, latency counted from KISS_SendFrame to the closing FEND leaving
+static void BenchmarkAirToHost(void)
+{
+	enum { FRAMES = 2000, EVERY_TICKS = 3, BYTES_PER_TICK = 38 };
+	static uint32_t Ends[FRAMES];
+	static uint32_t HeardAt[FRAMES];
+	uint32_t        Queued   = 0;
+	unsigned int    Heard    = 0;
+	unsigned int    Done     = 0;
+	uint32_t        Tick     = 0;
+	uint32_t        Latency  = 0;
+	uint32_t        MaxLatency = 0;
+	unsigned int    Report[4];
+	struct timespec Start;
+	struct timespec End;
+
+	gBenchmark  = true;
+	gSentToHost = 0;
+	KISS_Start();
+
+	clock_gettime(CLOCK_MONOTONIC, &Start);
+	while (Done < Heard || Heard < FRAMES)
+	{
+		if (Heard < FRAMES && Tick % EVERY_TICKS == 0)
+		{
+			uint8_t        Frame[120];
+			uint8_t        Escaped[2 * 120 + 4];
+			const uint16_t Length = 20 + Random() % 100;
+
+			for (uint16_t j = 0; j < Length; j++)
+				Frame[j] = (Random() % 64) ? 0x20 + Random() % 0x5F : 0xC0;
+			Queued += Escape(Frame, Length, Escaped);
+			Ends[Heard]    = Queued;
+			HeardAt[Heard] = Tick;
+			Heard++;
+			KISS_SendFrame((const char *)Frame, Length);
+		}
+
+		gTickBudget = BYTES_PER_TICK;
+		KISS_TimeSlice10ms();
+		Tick++;
+
+		for (; Done < Heard && gSentToHost >= Ends[Done]; Done++)
+		{
+			const uint32_t Ticks = Tick - HeardAt[Done];
+
+			Latency += Ticks;
+			if (Ticks > MaxLatency)
+				MaxLatency = Ticks;
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &End);
+
+	KISS_Report();
+	Check(sscanf(gReport, "KISS tx %u full %u long %u rx-dropped %u", &Report[0], &Report[1], &Report[2], &Report[3]) == 4 &&
+		Report[3] == 0, "nothing dropped to the host");
+
+	printf("kiss: air to host, %.1f frames/s at one per %u ms, latency %.1f ms, max %u ms, host time %.0f ns per frame\n",
+		FRAMES * 100.0 / Tick, EVERY_TICKS * 10, Latency * 10.0 / FRAMES, MaxLatency * 10,
+		Nanoseconds(&Start, &End) / FRAMES);
+
+	gBenchmark = false;
+}
+
+int main(void)
+{
+	CheckHostToAir();
+	CheckAirToHost();
+	BenchmarkHostToAir();
+	BenchmarkAirToHost();
+
+	// the return frame leaves KISS mode
+	KISS_Feed(0xC0);
+	KISS_Feed(0xFF);
+	KISS_Feed(0xC0);
+	Check(!KISS_IsActive(), "return frame");
+
+	printf("kiss: %u failures\n", gFailures);
+
+	return gFailures != 0;
+}
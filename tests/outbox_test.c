@@ -0,0 +1,128 @@
+// Runs messages through the APRS outbox. The addressee has to come out the
+// way the ack's source reads on air however it was typed, acks have to
+// settle only the message they are for, and an unanswered message has to
+// go out on the decaying schedule and then time out.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "app/aprs.h"
+#include "app/ax25.h"
+#include "settings.h"
+#include "tnc2.h"
+
+EEPROM_Config_t gEeprom;
+volatile uint32_t gGlobalSysTickCounter;
+
+static unsigned int failures;
+
+// the bundled printf wants this even though only snprintf is used
+void _putchar(char c) {
+    (void)c;
+}
+
+static void check(int ok, const char * what) {
+    if(!ok) {
+        printf("outbox: %s failed\n", what);
+        failures++;
+    }
+}
+
+static APRSOutbound * receive(const char * line) {
+    char frame[256];
+    AX25View view;
+    const uint16_t len = encode_tnc2(frame, line);
+
+    if(!APRS_parse(&view, frame, len))
+        return NULL;
+    return APRS_outbox_ack(&view);
+}
+
+/** Sends whatever is due, returns the entry that timed out, if any */
+static APRSOutbound * tick(void) {
+    APRSOutbound * due = APRS_outbox_timeslice_500ms();
+
+    if(due != NULL && due->state == APRS_DELIVERY_PENDING) {
+        APRS_outbox_sent(due);
+        return NULL;
+    }
+    return due;
+}
+
+static void check_addressee(const char * typed, const char * expected, const char * ack) {
+    APRSOutbound * entry = APRS_outbox_add(typed);
+    char line[64];
+
+    check(entry != NULL, typed);
+    if(entry == NULL)
+        return;
+    if(strcmp(entry->addressee, expected) != 0) {
+        printf("outbox: \"%s\" stored as \"%s\", not \"%s\"\n", typed, entry->addressee, expected);
+        failures++;
+    }
+
+    APRS_outbox_sent(entry);
+    snprintf(line, sizeof(line), "%s>APRS,WIDE1-1::N0CALL-9 :ack%u", ack, entry->id);
+    check(receive(line) == entry && entry->state == APRS_DELIVERY_ACKED, line);
+}
+
+int main(void) {
+    strcpy(gEeprom.APRS_CONFIG.callsign, "N0CALL");
+    gEeprom.APRS_CONFIG.ssid = 9;
+
+    check(APRS_outbox_add("hello") == NULL, "no addressee");
+    check(APRS_outbox_add("   :hello") == NULL, "blank addressee");
+    check(APRS_outbox_add("-0:hello") == NULL, "just -0");
+
+    check_addressee("ea4iau:hi", "EA4IAU", "EA4IAU");
+    check_addressee("EA4IAU-0:hi", "EA4IAU", "EA4IAU");
+    check_addressee(" ea4iau-0 :hi", "EA4IAU", "EA4IAU");
+    check_addressee("dl1abc-7:hi", "DL1ABC-7", "DL1ABC-7");
+    check_addressee("K1ABC-10 :hi", "K1ABC-10", "K1ABC-10");
+
+    // acks from the wrong station or for another id leave it pending
+    APRSOutbound * entry = APRS_outbox_add("oe1xyz:ping");
+    char line[64];
+
+    check(entry != NULL, "add");
+    if(entry == NULL)
+        return 1;
+    tick();
+    check(entry->sent == 1, "sent when added");
+
+    snprintf(line, sizeof(line), "K1ABC>APRS::N0CALL-9 :ack%u", entry->id);
+    check(receive(line) == NULL, "ack from another station");
+    snprintf(line, sizeof(line), "OE1XYZ>APRS::N0CALL-9 :ack%u", entry->id + 1);
+    check(receive(line) == NULL, "ack for another id");
+    snprintf(line, sizeof(line), "OE1XYZ>APRS::N0CALL-7 :ack%u", entry->id);
+    check(receive(line) == NULL, "ack for another station");
+    check(entry->state == APRS_DELIVERY_PENDING, "still pending");
+
+    // never answered: 30s, then 1, 2, 4 and 8 minutes, then it times out
+    {
+        static const unsigned int due[] = { 30, 90, 210, 450 };
+        unsigned int sends = 0;
+        unsigned int seconds_2 = 0;
+        APRSOutbound * timed_out = NULL;
+
+        while(timed_out == NULL && seconds_2 < 4000) {
+            const uint8_t sent = entry->sent;
+
+            timed_out = tick();
+            seconds_2++;
+            if(entry->sent != sent) {
+                check(sends < 4 && seconds_2 / 2 == due[sends], "retry schedule");
+                sends++;
+            }
+        }
+        check(timed_out == entry && entry->state == APRS_DELIVERY_TIMEOUT && seconds_2 / 2 == 930, "timeout");
+        check(entry->sent == APRS_MESSAGE_TRANSMISSIONS, "transmissions");
+    }
+
+    snprintf(line, sizeof(line), "OE1XYZ>APRS::N0CALL-9 :ack%u", entry->id);
+    check(receive(line) == NULL, "ack after the timeout");
+
+    printf("outbox: %u failures\n", failures);
+
+    return failures != 0;
+}
@@ -0,0 +1,327 @@
+// Feeds the received frame parsers everything the air can throw at them.
+// Every frame in aprs_corpus.txt has to parse and read back the way it was
+// written; cut short at any length, with an address chain that never ends
+// or runs past 8 digipeaters, or without the UI control and no-layer-3 PID
+// it has to be turned away. Then times the corpus through APRS_parse and
+// mutates it at random, checking that whatever parses stays inside its
+// buffer and that every accessor the messenger uses copes with it.
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "app/aprs.h"
+#include "app/ax25.h"
+#include "app/messenger.h"
+#include "settings.h"
+#include "tnc2.h"
+
+EEPROM_Config_t gEeprom;
+volatile uint32_t gGlobalSysTickCounter;
+
+#define CORPUS_SIZE 64
+
+static unsigned int failures;
+
+static char lines[CORPUS_SIZE][256];
+static char frames[CORPUS_SIZE][AX25_IFRAME_MAX_SIZE];
+static uint16_t lens[CORPUS_SIZE];
+static unsigned int corpus_size;
+
+// the bundled printf wants this even though only snprintf is used
+void _putchar(char c) {
+    (void)c;
+}
+
+static void check(int ok, const char * what, const char * line) {
+    if(!ok) {
+        printf("parse: %s failed, %s\n", what, line);
+        failures++;
+    }
+}
+
+static uint32_t random32(void) {
+    static uint32_t state = 0x2545F491;
+
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static uint8_t load_corpus(const char * path) {
+    FILE * file = fopen(path, "r");
+    char line[256];
+
+    if(file == NULL)
+        return 0;
+    while(fgets(line, sizeof(line), file) != NULL && corpus_size < CORPUS_SIZE) {
+        line[strcspn(line, "\r\n")] = 0;
+        if(line[0] == '#' || line[0] == 0)
+            continue;
+        strcpy(lines[corpus_size], line);
+        lens[corpus_size] = encode_tnc2(frames[corpus_size], line);
+        corpus_size++;
+    }
+    fclose(file);
+    return corpus_size > 0;
+}
+
+/** Writes a frame the TNC2 way, repeated digipeaters marked with '*' */
+static void decode_tnc2(const AX25View * view, char * line) {
+    char address[AX25_ADDRESS_STRING_SIZE + 1];
+
+    AX25_address_to_string(view, AX25_SOURCE, address);
+    line += sprintf(line, "%s>", address);
+    AX25_address_to_string(view, AX25_DESTINATION, address);
+    line += sprintf(line, "%s", address);
+    for(uint8_t i = AX25_FIRST_DIGI; i < view->addresses; i++) {
+        AX25_address_to_string(view, i, address);
+        line += sprintf(line, ",%s%s", address, AX25_repeated(view, i) ? "*" : "");
+    }
+    sprintf(line, ":%.*s", (int)AX25_info_len(view), AX25_info(view));
+}
+
+static void check_corpus(void) {
+    for(unsigned int i = 0; i < corpus_size; i++) {
+        AX25View view;
+        char line[512];
+
+        check(APRS_parse(&view, frames[i], lens[i]), "parse", lines[i]);
+        decode_tnc2(&view, line);
+        check(strcmp(line, lines[i]) == 0, "read back", lines[i]);
+        check(view.has_pid && view.control == view.addresses * CALLSIGN_SIZE, "control", lines[i]);
+    }
+}
+
+// every cut short of the information field loses the frame, from there on
+// AX25 takes it and APRS wants at least one byte of information
+static void check_truncated(void) {
+    for(unsigned int i = 0; i < corpus_size; i++) {
+        AX25View full;
+
+        if(!APRS_parse(&full, frames[i], lens[i]))
+            continue;
+        for(uint16_t len = 0; len < lens[i]; len++) {
+            char * copy = malloc(len ? len : 1);
+            AX25View view;
+
+            memcpy(copy, frames[i], len);
+            if(len < full.info)
+                check(!AX25_parse(&view, copy, len), "truncated", lines[i]);
+            else if(len == full.info)
+                check(AX25_parse(&view, copy, len) && !APRS_parse(&view, copy, len), "no information", lines[i]);
+            else
+                check(APRS_parse(&view, copy, len) && AX25_info_len(&view) == len - full.info, "short information", lines[i]);
+            free(copy);
+        }
+    }
+}
+
+static void check_addresses(void) {
+    static const struct {
+        const char * path;
+        uint8_t digis;
+    } paths[] = {
+        { "", 0 },
+        { ",WIDE1-1", 1 },
+        { ",WIDE1-1,WIDE2-1", 2 },
+        { ",A,B,C,D,E,F,G", 7 },
+        { ",A,B,C,D,E,F,G,H", 8 },
+        { ",A,B,C,D,E,F,G,H,I", 9 },
+    };
+    char frame[AX25_IFRAME_MAX_SIZE + CALLSIGN_SIZE];
+    char line[128];
+    uint16_t len;
+    AX25View view;
+
+    for(uint8_t i = 0; i < sizeof(paths) / sizeof(paths[0]); i++) {
+        snprintf(line, sizeof(line), "N0CALL>APRS%s:>status", paths[i].path);
+        len = encode_tnc2(frame, line);
+        check(AX25_parse(&view, frame, len) == (paths[i].digis <= MAX_DIGIS), "digipeater count", line);
+
+        // the end bit never comes, the chain runs into the information
+        for(uint8_t a = 0; a < 2 + paths[i].digis; a++)
+            frame[a * CALLSIGN_SIZE + CALLSIGN_SIZE - 1] &= ~0x01;
+        check(!AX25_parse(&view, frame, len), "no end bit", line);
+
+        // the end bit on the destination leaves no source
+        frame[CALLSIGN_SIZE - 1] |= 0x01;
+        check(!AX25_parse(&view, frame, len), "end bit on the destination", line);
+    }
+
+    // a callsign byte with bit 0 set isn't an address
+    len = encode_tnc2(frame, "N0CALL>APRS:>status");
+    frame[CALLSIGN_SIZE + 2] |= 0x01;
+    check(!AX25_parse(&view, frame, len), "bit 0 in a callsign", "N0CALL>APRS:>status");
+}
+
+// APRS only takes UI frames without layer 3, the poll bit aside
+static void check_control(void) {
+    static const struct {
+        uint8_t control;
+        uint8_t pid;
+        uint8_t ax25;
+        uint8_t aprs;
+    } cases[] = {
+        { 0x03, 0xF0, 1, 1 },
+        { 0x13, 0xF0, 1, 1 },
+        { 0x03, 0xCF, 1, 0 },
+        { 0x03, 0x00, 1, 0 },
+        { 0x00, 0xF0, 1, 0 },   // I frame
+        { 0x01, 0xF0, 1, 0 },   // S frame, no PID so 0xF0 is information
+        { 0x2F, 0xF0, 1, 0 },   // SABM
+        { 0xF0, 0x03, 1, 0 },   // swapped
+    };
+    const char * line = "N0CALL>APRS,WIDE1-1:>status";
+    char frame[AX25_IFRAME_MAX_SIZE];
+    const uint16_t len = encode_tnc2(frame, line);
+    const uint8_t control = 3 * CALLSIGN_SIZE;
+    AX25View view;
+
+    for(uint8_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        frame[control] = cases[i].control;
+        frame[control + 1] = cases[i].pid;
+        check(AX25_parse(&view, frame, len) == cases[i].ax25, "control and pid, AX25", line);
+        check(APRS_parse(&view, frame, len) == cases[i].aprs, "control and pid, APRS", line);
+    }
+
+    // the addresses and nothing after them, then only a UI control
+    check(!AX25_parse(&view, frame, control), "no control", line);
+    frame[control] = AX25_CONTROL_UI;
+    check(!AX25_parse(&view, frame, control + 1), "no pid", line);
+}
+
+/** Everything the messenger and digipeater read from a received frame */
+static void use(const AX25View * view) {
+    static char field[MESSAGE_LENGTH + 2];
+    char address[AX25_ADDRESS_STRING_SIZE + 1];
+
+    if(view->addresses < 2 || view->addresses > AX25_MAX_ADDRESSES ||
+        view->control != view->addresses * CALLSIGN_SIZE || view->info > view->len) {
+        printf("parse: view out of its buffer, %u addresses, info at %u of %u\n",
+            view->addresses, view->info, view->len);
+        failures++;
+        return;
+    }
+    for(uint8_t i = 0; i < view->addresses; i++) {
+        AX25_address_to_string(view, i, address);
+        if(strlen(address) > AX25_ADDRESS_STRING_SIZE) {
+            printf("parse: address %u too long\n", i);
+            failures++;
+        }
+    }
+    AX25_next_digi(view);
+    if(APRS_get_type(view) == APRS_TYPE_MESSAGE)
+        APRS_destined_to_user(view);
+    APRS_get_msg_id(view);
+    APRS_dupe_check(view);
+    APRS_display_received(view, field);
+    if(strlen(field) > MESSAGE_LENGTH + 1) {
+        printf("parse: displayed %u characters\n", (unsigned int)strlen(field));
+        failures++;
+    }
+}
+
+// corpus frames with bits flipped, bytes replaced, cut or grown, and plain
+// noise, each in a buffer of its exact size so a sanitizer sees overreads
+static void fuzz(void) {
+    enum { ROUNDS = 200000 };
+    unsigned int parsed = 0;
+    unsigned int aprs = 0;
+
+    for(unsigned int r = 0; r < ROUNDS; r++) {
+        char frame[AX25_IFRAME_MAX_SIZE + 64];
+        uint16_t len;
+        AX25View view;
+
+        if(r % 8 == 0) {
+            len = random32() % sizeof(frame);
+            for(uint16_t i = 0; i < len; i++)
+                frame[i] = random32();
+        } else {
+            const unsigned int pick = random32() % corpus_size;
+            const uint8_t mutations = 1 + random32() % 4;
+
+            len = lens[pick];
+            memcpy(frame, frames[pick], len);
+            for(uint8_t m = 0; m < mutations && len > 0; m++) {
+                const uint16_t at = random32() % len;
+
+                switch(random32() % 5) {
+                    case 0: frame[at] ^= 1 << (random32() % 8); break;
+                    case 1: frame[at] = random32(); break;
+                    case 2: frame[at - at % CALLSIGN_SIZE + CALLSIGN_SIZE - 1] ^= 0x01; break;
+                    case 3: len = at; break;
+                    case 4:
+                        while(len < sizeof(frame) && random32() % 16)
+                            frame[len++] = random32();
+                        break;
+                }
+            }
+        }
+
+        char * copy = malloc(len ? len : 1);
+        memcpy(copy, frame, len);
+        gGlobalSysTickCounter += 7;
+        if(AX25_parse(&view, copy, len)) {
+            parsed++;
+            if(APRS_parse(&view, copy, len)) {
+                aprs++;
+                use(&view);
+            }
+        }
+        free(copy);
+    }
+
+    printf("parse: fuzzed %u frames, %u parsed as AX25, %u as APRS\n", ROUNDS, parsed, aprs);
+}
+
+static void benchmark(void) {
+    enum { ROUNDS = 20000 };
+    struct timespec start;
+    struct timespec end;
+    unsigned long bytes = 0;
+    unsigned int parsed = 0;
+    double ns;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(unsigned int r = 0; r < ROUNDS; r++) {
+        for(unsigned int i = 0; i < corpus_size; i++) {
+            AX25View view;
+
+            if(APRS_parse(&view, frames[i], lens[i]))
+                parsed += APRS_get_type(&view) != APRS_TYPE_OTHER;
+            bytes += lens[i];
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    ns = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+
+    printf("parse: corpus of %u frames, %.0f frames/s, %.0f ns per frame, %.1f MB/s (%u typed)\n",
+        corpus_size, ROUNDS * corpus_size * 1e9 / ns, ns / (ROUNDS * corpus_size), bytes * 1e3 / ns, parsed / ROUNDS);
+}
+
+int main(void) {
+    strcpy(gEeprom.APRS_CONFIG.callsign, "N0CALL");
+    gEeprom.APRS_CONFIG.ssid = 9;
+
+    if(!load_corpus("aprs_corpus.txt")) {
+        printf("parse: can't read aprs_corpus.txt, run from tests/\n");
+        return 1;
+    }
+
+    check_corpus();
+    check_truncated();
+    check_addresses();
+    check_control();
+    benchmark();
+    fuzz();
+
+    printf("parse: %u failures\n", failures);
+
+    return failures != 0;
+}
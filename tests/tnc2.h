@@ -0,0 +1,58 @@
+// Builds AX.25 frames from TNC2 monitor lines, "SOURCE>DEST,DIGI*:info",
+// for the tests that feed received traffic to the APRS code.
+
+#ifndef TESTS_TNC2_H
+#define TESTS_TNC2_H
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "app/ax25.h"
+
+/** One "CALL-SS" or "CALL-SS*" address, on air */
+static inline uint16_t encode_address(char * dest, const char * address, uint8_t last) {
+    uint8_t i = 0;
+    uint8_t ssid = 0;
+    const char * p = address;
+
+    for(; *p && *p != '-' && *p != '*' && i < 6; p++, i++)
+        dest[i] = *p << 1;
+    for(; i < 6; i++)
+        dest[i] = ' ' << 1;
+    if(*p == '-')
+        ssid = atoi(++p);
+    while(*p && *p != '*')
+        p++;
+    dest[6] = 0x60 | (ssid << 1) | (*p == '*' ? 0x80 : 0) | last;
+    return CALLSIGN_SIZE;
+}
+
+/** A frame written the TNC2 way, "SOURCE>DEST,DIGI*:info" */
+static inline uint16_t encode_tnc2(char * dest, const char * line) {
+    char text[256];
+    char * addresses[AX25_MAX_ADDRESSES + 1];   // one past, for chains that are too long
+    uint8_t count = 0;
+    uint16_t len = 0;
+
+    strcpy(text, line);
+    char * info = strchr(text, ':');
+    *info++ = 0;
+    char * gt = strchr(text, '>');
+    *gt = 0;
+
+    addresses[count++] = gt + 1;
+    addresses[count++] = text;
+    for(char * c = strchr(gt + 1, ','); c; c = strchr(c + 1, ',')) {
+        *c = 0;
+        addresses[count++] = c + 1;
+    }
+    for(uint8_t i = 0; i < count; i++)
+        len += encode_address(dest + len, addresses[i], i == count - 1);
+
+    dest[len++] = AX25_CONTROL_UI;
+    dest[len++] = AX25_PID_NO_LAYER3;
+    memcpy(dest + len, info, strlen(info));
+    return len + strlen(info);
+}
+
+#endif
@@ -84,6 +84,9 @@ void UI_PrintString(const char *pString, uint8_t Start, uint8_t End, uint8_t Lin
 			memmove(gFrameBuffer[Line + 1] + ofs, &gFontBig[index][7], 7);
 		}
 	}
+
+	ST7565_MarkDirty(Line + 0, Start, Length * Width);
+	ST7565_MarkDirty(Line + 1, Start, Length * Width);
 }
 
 void UI_PrintStringSmall(const char *pString, uint8_t Start, uint8_t End, uint8_t Line)
@@ -108,6 +111,8 @@ void UI_PrintStringSmall(const char *pString, uint8_t Start, uint8_t End, uint8_
 				memmove(pFb + (i * char_spacing) + 1, &gFontSmall[index], char_width);
 		}
 	}
+
+	ST7565_MarkDirty(Line, Start, Length * char_spacing + 1);
 }
 
 #ifdef ENABLE_SMALL_BOLD
@@ -131,6 +136,8 @@ void UI_PrintStringSmall(const char *pString, uint8_t Start, uint8_t End, uint8_
 					memmove(pFb + (i * char_spacing) + 1, &gFontSmallBold[index], char_width);
 			}
 		}
+
+		ST7565_MarkDirty(Line, Start, Length * char_spacing + 1);
 	}
 #endif
 
@@ -183,6 +190,10 @@ void UI_DisplayFrequency(const char *string, uint8_t X, uint8_t Y, bool center)
 		pFb0 += char_width;
 		pFb1 += char_width;
 	}
+
+	// centering can move left of X, take the whole lines
+	ST7565_MarkDirty(Y + 0, 0, LCD_WIDTH);
+	ST7565_MarkDirty(Y + 1, 0, LCD_WIDTH);
 }
 
 void UI_DrawPixelBuffer(uint8_t (*buffer)[128], uint8_t x, uint8_t y, bool black) 
@@ -191,6 +202,9 @@ void UI_DrawPixelBuffer(uint8_t (*buffer)[128], uint8_t x, uint8_t y, bool black
 		buffer[y/8][x] |= 1 << (y%8);
 	else
 		buffer[y/8][x] &= ~(1 << (y%8));
+
+	if(buffer == gFrameBuffer)
+		ST7565_MarkDirty(y/8, x, 1);
 }
 
 static void sort(int16_t *a, int16_t *b)
@@ -69,7 +69,8 @@ void UI_DisplayLock(void)
 
 	while (1)
 	{
-		while (!gNextTimeslice) {}
+		while (!gNextTimeslice)
+			ST7565_Pump();
 
 		// TODO: Original code doesn't do the below, but is needed for proper key debounce
 
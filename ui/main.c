@@ -76,6 +76,8 @@ static void DrawLevelBar(uint8_t xpos, uint8_t line, uint8_t level)
 			memcpy(p_line + (xpos + i * 5), &hollowBar, ARRAY_SIZE(hollowBar));
 		}
 	}
+
+	ST7565_MarkDirty(line, xpos, level * 5);
 }
 #endif
 
@@ -128,11 +130,12 @@ void UI_DisplayAudioBar(void)
 
 	uint8_t *p_line = gFrameBuffer[line];
 	memset(p_line, 0, LCD_WIDTH);
+	ST7565_MarkDirty(line, 0, LCD_WIDTH);
 
 	DrawLevelBar(62, line, bars);
 
 	if (gCurrentFunction == FUNCTION_TRANSMIT)
-		ST7565_BlitFullScreen();
+		ST7565_BlitDirty();
 
 }
 #endif
@@ -171,8 +174,10 @@ static void DisplayRSSIBar(const int16_t rssi, const bool now)
 			)
 			return;     // display is in use
 
-		if (now)
+		if (now) {
 			memset(p_line, 0, LCD_WIDTH);
+			ST7565_MarkDirty(line, 0, LCD_WIDTH);
+		}
 
 		sLevelAttributes sLevelAtt;
 		
@@ -186,6 +191,7 @@ static void DisplayRSSIBar(const int16_t rssi, const bool now)
 		else {
 			sprintf(str, "% 4d  %2d", sLevelAtt.dBmRssi, sLevelAtt.over);
 			memcpy(p_line + 2 + 7*5, &plus, ARRAY_SIZE(plus));
+			ST7565_MarkDirty(line, 2 + 7*5, ARRAY_SIZE(plus));
 		}
 
 		UI_PrintStringSmall(str, 2, 0, line);
@@ -208,14 +214,16 @@ static void DisplayRSSIBar(const int16_t rssi, const bool now)
 		Level = 0;
 	}
 
-	uint8_t *pLine = (gEeprom.RX_VFO == 0)? gFrameBuffer[2] : gFrameBuffer[6];
+	const unsigned int line = (gEeprom.RX_VFO == 0)? 2 : 6;
+	uint8_t *pLine = gFrameBuffer[line];
 	if (now)
 		memset(pLine, 0, 23);
 	DrawSmallAntennaAndBars(pLine, Level);
+	ST7565_MarkDirty(line, 0, 23);
 #endif
 
 	if (now)
-		ST7565_BlitFullScreen();
+		ST7565_BlitDirty();
 }
 
 
@@ -126,12 +126,18 @@ const t_menu_item MenuList[] =
 	{"MsgAck", VOICE_ID_INVALID,                       MENU_MSG_ACK       }, // messenger respond ACK
 	{"MsgMod", VOICE_ID_INVALID,                       MENU_MSG_MODULATION}, // messenger modulation
 	{"NRZIsk", VOICE_ID_INVALID,                       MENU_MSG_NRZI      }, // non-return-zero encoding
+#ifdef ENABLE_MESSENGER_FEC
+	{"MsgFEC", VOICE_ID_INVALID,                       MENU_MSG_FEC       }, // messenger forward error correction
+#endif
 #ifdef ENABLE_APRS
 	{"CallSg", VOICE_ID_INVALID,                       MENU_APRS_CALLSIGN  }, // APRS callsign
 	{"SSID"  , VOICE_ID_INVALID,                       MENU_APRS_SSID      }, // APRS SSID
 	{"Path1" , VOICE_ID_INVALID,                       MENU_APRS_PATH1     }, // APRS path 1
 	{"Path2" , VOICE_ID_INVALID,                       MENU_APRS_PATH2     }, // APRS path 2
 #endif
+#ifdef ENABLE_APRS_DIGI
+	{"Digi"  , VOICE_ID_INVALID,                       MENU_APRS_DIGI      }, // APRS digipeater max hops
+#endif
 #endif
 	{"Sql",    VOICE_ID_SQUELCH,                       MENU_SQL           },
 	// hidden menu items from here on
@@ -645,6 +651,15 @@ void UI_DisplayMenu(void)
 					break;
 			#endif
 
+			#ifdef ENABLE_APRS_DIGI
+				case MENU_APRS_DIGI:
+					if (gSubMenuSelection == 0)
+						strcpy(String, "OFF");
+					else
+						sprintf(String, "WIDE%d", gSubMenuSelection);
+					break;
+			#endif
+
 			case MENU_ABR:
 				strcpy(String, gSubMenu_BACKLIGHT[gSubMenuSelection]);
 				break;
@@ -693,6 +708,9 @@ void UI_DisplayMenu(void)
 				case MENU_MSG_ACK:
 				case MENU_MSG_NRZI:
 			#endif
+			#ifdef ENABLE_MESSENGER_FEC
+				case MENU_MSG_FEC:
+			#endif
 			case MENU_350TX:
 			case MENU_200TX:
 			case MENU_500TX:
@@ -75,12 +75,18 @@ enum
 	MENU_MSG_MODULATION,
 	MENU_MSG_NRZI,
 #endif
+#ifdef ENABLE_MESSENGER_FEC
+	MENU_MSG_FEC,
+#endif
 
 #ifdef ENABLE_APRS
 	MENU_APRS_CALLSIGN,
 	MENU_APRS_SSID,
 	MENU_APRS_PATH1,
 	MENU_APRS_PATH2,
+#endif
+#ifdef ENABLE_APRS_DIGI
+	MENU_APRS_DIGI,
 #endif
 	MENU_BEEP,
 #ifdef ENABLE_VOICE
@@ -49,7 +49,7 @@ void UI_DisplayScanner(void)
 	if (gScanCssResultType == CODE_TYPE_CONTINUOUS_TONE)
 		sprintf(String, "CTC:%u.%uHz", CTCSS_Options[gScanCssResultCode] / 10, CTCSS_Options[gScanCssResultCode] % 10);
 	else
-		sprintf(String, "DCS:D%03oN", DCS_Options[gScanCssResultCode]);
+		sprintf(String, "DCS:D%03o%c", DCS_Options[gScanCssResultCode], (gScanCssResultType == CODE_TYPE_REVERSE_DIGITAL) ? 'I' : 'N');
 	UI_PrintString(String, 2, 0, 3, 8);
 
 	memset(String, 0, sizeof(String));
@@ -70,6 +70,8 @@ void UI_DisplayScanner(void)
 			strcpy(String, "SCAN");
 			memset(String + 4, '.', (gScanProgressIndicator & 7) + 1);
 		}
+		else if (gScanCssState == SCAN_CSS_STATE_FOUND && gScanUseCssResult)
+			sprintf(String, "CMP %u.%02us F%u", gScanCssLockTime_10ms / 100, gScanCssLockTime_10ms % 100, gScanCssFalseHits);
 		else if (gScanCssState == SCAN_CSS_STATE_FOUND)
 			strcpy(String, "SCAN CMP.");
 		else
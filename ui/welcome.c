@@ -40,6 +40,7 @@ void UI_DisplayReleaseKeys(void)
 
 	ST7565_BlitStatusLine();  // blank status line
 	ST7565_BlitFullScreen();
+	ST7565_Flush();           // the main loop isn't pumping yet
 }
 
 void UI_DisplayWelcome(void)
@@ -85,5 +86,7 @@ void UI_DisplayWelcome(void)
 		ST7565_BlitStatusLine();  // blank status line
 		ST7565_BlitFullScreen();
 	}
+
+	ST7565_Flush();               // the main loop isn't pumping yet
 }
 